@@ -2,8 +2,33 @@
 #include <vector>
 #include <algorithm>
 #include <string>
+#include <string_view>
+#include <set>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <stdexcept>
+#include <chrono>
+#include <charconv>
+#include <fstream>
+#include <sstream>
+#include <numeric>
+#include <thread>
+#include <exception>
 #include <cassert>
 
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX // Keep std::min and std::max usable
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 using namespace std;
 
 class Customer {
@@ -18,11 +43,12 @@ private:
 
 public:
     // Constructor with full details.
-    Customer(int id, const string& lastName, const string& firstName,
-             const string& middleName, const string& address,
-             const string& creditCardNumber, const string& bankAccountNumber)
-        : id(id), lastName(lastName), firstName(firstName), middleName(middleName),
-          address(address), creditCardNumber(creditCardNumber), bankAccountNumber(bankAccountNumber) {}
+    // Takes the strings by value so callers can move them in.
+    Customer(int id, string lastName, string firstName, string middleName, string address,
+             string creditCardNumber, string bankAccountNumber)
+        : id(id), lastName(move(lastName)), firstName(move(firstName)), middleName(move(middleName)),
+          address(move(address)), creditCardNumber(move(creditCardNumber)),
+          bankAccountNumber(move(bankAccountNumber)) {}
 
     // Constructor with minimal details.
     Customer(int id, const string& lastName, const string& firstName)
@@ -38,11 +64,73 @@ public:
         return lastName + " " + firstName;
     }
 
+    // Returns the customer's id.
+    int getId() const {
+        return id;
+    }
+
+    // Returns the customer's last name.
+    const string& getLastName() const {
+        return lastName;
+    }
+
+    // Returns the customer's first name.
+    const string& getFirstName() const {
+        return firstName;
+    }
+
+    // Returns the customer's middle name.
+    const string& getMiddleName() const {
+        return middleName;
+    }
+
+    // Returns the customer's address.
+    const string& getAddress() const {
+        return address;
+    }
+
     // Returns the customer's credit card number.
-    string getCreditCardNumber() const {
+    const string& getCreditCardNumber() const {
         return creditCardNumber;
     }
 
+    // Returns the customer's bank account number.
+    const string& getBankAccountNumber() const {
+        return bankAccountNumber;
+    }
+
+    // Three-way comparison in the same order as comparing getFullName(), walking
+    // the last name, the separating space and the first name in place instead of
+    // building the concatenated strings.
+    static int compareFullName(const Customer& a, const Customer& b) {
+        const string_view left[] = { a.lastName, " ", a.firstName };
+        const string_view right[] = { b.lastName, " ", b.firstName };
+        size_t i = 0, j = 0;
+        string_view x = left[0], y = right[0];
+        while (true) {
+            while (x.empty() && i < 2) {
+                x = left[++i];
+            }
+            while (y.empty() && j < 2) {
+                y = right[++j];
+            }
+            if (x.empty() || y.empty()) {
+                return x.empty() ? (y.empty() ? 0 : -1) : 1;
+            }
+            size_t length = min(x.size(), y.size());
+            int cmp = x.substr(0, length).compare(y.substr(0, length));
+            if (cmp != 0) {
+                return cmp;
+            }
+            x.remove_prefix(length);
+            y.remove_prefix(length);
+        }
+    }
+
+    static bool fullNameLess(const Customer& a, const Customer& b) {
+        return compareFullName(a, b) < 0;
+    }
+
     // Overloads the output operator to display customer information.
     friend ostream& operator<<(ostream& os, const Customer& customer) {
         os << "Customer{id=" << customer.id
@@ -56,37 +144,983 @@ public:
     }
 };
 
+// Read-only memory mapping of a whole file.
+class MappedFile {
+private:
+    const char* bytes = nullptr;
+    size_t length = 0;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#endif
+
+public:
+    explicit MappedFile(const string& path) {
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                           FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        LARGE_INTEGER fileSize;
+        if (file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &fileSize)) {
+            close();
+            throw runtime_error("Cannot open file: " + path);
+        }
+        length = static_cast<size_t>(fileSize.QuadPart);
+        if (length > 0) {
+            mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            bytes = mapping ? static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+            if (bytes == nullptr) {
+                close();
+                throw runtime_error("Cannot map file: " + path);
+            }
+        }
+#else
+        int fd = open(path.c_str(), O_RDONLY);
+        struct stat info;
+        if (fd < 0 || fstat(fd, &info) != 0) {
+            if (fd >= 0) {
+                ::close(fd);
+            }
+            throw runtime_error("Cannot open file: " + path);
+        }
+        length = static_cast<size_t>(info.st_size);
+        if (length > 0) {
+            void* view = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (view == MAP_FAILED) {
+                ::close(fd);
+                throw runtime_error("Cannot map file: " + path);
+            }
+            madvise(view, length, MADV_SEQUENTIAL);
+            bytes = static_cast<const char*>(view);
+        }
+        ::close(fd);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() {
+        close();
+    }
+
+    const char* data() const {
+        return bytes;
+    }
+
+    size_t size() const {
+        return length;
+    }
+
+private:
+    void close() {
+#ifdef _WIN32
+        if (bytes != nullptr) {
+            UnmapViewOfFile(bytes);
+        }
+        if (mapping != nullptr) {
+            CloseHandle(mapping);
+        }
+        if (file != INVALID_HANDLE_VALUE) {
+            CloseHandle(file);
+        }
+        mapping = nullptr;
+        file = INVALID_HANDLE_VALUE;
+#else
+        if (bytes != nullptr) {
+            munmap(const_cast<char*>(bytes), length);
+        }
+#endif
+        bytes = nullptr;
+    }
+};
+
+// Runs task(0) .. task(taskCount - 1), each on its own thread; task 0 runs on the caller's.
+template <typename Task>
+void runInThreads(size_t taskCount, Task task) {
+    vector<thread> workers;
+    for (size_t i = 1; i < taskCount; ++i) {
+        workers.emplace_back(task, i);
+    }
+    if (taskCount > 0) {
+        task(0);
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+// Sorts items with one std::sort per thread followed by rounds of pairwise
+// merges, each round also spread across threads.
+template <typename T, typename Compare>
+void parallelSort(vector<T>& items, Compare less, unsigned threadCount) {
+    size_t chunks = max<size_t>(1, min<size_t>(threadCount, items.size() / 4096));
+    vector<size_t> bounds(chunks + 1);
+    for (size_t i = 0; i <= chunks; ++i) {
+        bounds[i] = items.size() * i / chunks;
+    }
+    runInThreads(chunks, [&](size_t i) {
+        sort(items.begin() + bounds[i], items.begin() + bounds[i + 1], less);
+    });
+
+    vector<T> merged(items.size());
+    for (size_t width = 1; width < chunks; width *= 2) {
+        size_t pairs = (chunks + 2 * width - 1) / (2 * width);
+        runInThreads(pairs, [&](size_t pair) {
+            size_t first = bounds[pair * 2 * width];
+            size_t middle = bounds[min(chunks, pair * 2 * width + width)];
+            size_t last = bounds[min(chunks, pair * 2 * width + 2 * width)];
+            merge(items.begin() + first, items.begin() + middle, items.begin() + middle, items.begin() + last,
+                  merged.begin() + first, less);
+        });
+        items.swap(merged);
+    }
+}
+
+// Outcome of a bulk load.
+struct BulkLoadReport {
+    size_t rows;
+    double seconds;
+
+    double rowsPerSecond() const {
+        return seconds > 0 ? rows / seconds : 0;
+    }
+};
+
+// Output layout of a customer report.
+enum class ReportFormat {
+    Text, // Same layout as operator<<, one customer per line
+    Csv   // The layout read by CustomerManager::loadCsv
+};
+
+// Formats customers into a reusable buffer and hands it to the stream in large
+// blocks, instead of formatting and flushing every record separately.
+class CustomerReportWriter {
+private:
+    ostream& out;
+    ReportFormat format;
+    vector<char> buffer;
+    size_t used = 0;
+
+    void append(const char* data, size_t length) {
+        if (length > buffer.size() - used) {
+            flush();
+            if (length > buffer.size()) {
+                out.write(data, length);
+                return;
+            }
+        }
+        memcpy(buffer.data() + used, data, length);
+        used += length;
+    }
+
+    void append(const string& value) {
+        append(value.data(), value.size());
+    }
+
+    template <size_t N>
+    void appendLiteral(const char (&literal)[N]) {
+        append(literal, N - 1);
+    }
+
+    void append(char value) {
+        append(&value, 1);
+    }
+
+    void appendNumber(int value) {
+        char digits[16];
+        char* last = to_chars(digits, digits + sizeof(digits), value).ptr;
+        append(digits, last - digits);
+    }
+
+    // Quotes a CSV field only when it holds a separator or a quote.
+    void appendCsvField(const string& value) {
+        if (value.find_first_of(",\"\r\n") == string::npos) {
+            append(value);
+            return;
+        }
+        append('"');
+        size_t start = 0;
+        for (size_t quote = value.find('"'); quote != string::npos; quote = value.find('"', start)) {
+            append(value.data() + start, quote + 1 - start);
+            append('"');
+            start = quote + 1;
+        }
+        append(value.data() + start, value.size() - start);
+        append('"');
+    }
+
+public:
+    CustomerReportWriter(ostream& out, ReportFormat format = ReportFormat::Text, size_t bufferSize = 1 << 20)
+        : out(out), format(format), buffer(max<size_t>(bufferSize, 1)) {}
+
+    CustomerReportWriter(const CustomerReportWriter&) = delete;
+    CustomerReportWriter& operator=(const CustomerReportWriter&) = delete;
+
+    ~CustomerReportWriter() {
+        flush();
+    }
+
+    // Writes a line of free text, such as a title or a CSV header.
+    void writeLine(const string& line) {
+        append(line);
+        append('\n');
+    }
+
+    // Writes one customer followed by a line break.
+    void write(const Customer& customer) {
+        if (format == ReportFormat::Csv) {
+            appendNumber(customer.getId());
+            append(',');
+            appendCsvField(customer.getLastName());
+            append(',');
+            appendCsvField(customer.getFirstName());
+            append(',');
+            appendCsvField(customer.getMiddleName());
+            append(',');
+            appendCsvField(customer.getAddress());
+            append(',');
+            appendCsvField(customer.getCreditCardNumber());
+            append(',');
+            appendCsvField(customer.getBankAccountNumber());
+        } else {
+            appendLiteral("Customer{id=");
+            appendNumber(customer.getId());
+            appendLiteral(", lastName='");
+            append(customer.getLastName());
+            appendLiteral("', firstName='");
+            append(customer.getFirstName());
+            appendLiteral("', middleName='");
+            append(customer.getMiddleName());
+            appendLiteral("', address='");
+            append(customer.getAddress());
+            appendLiteral("', creditCardNumber='");
+            append(customer.getCreditCardNumber());
+            appendLiteral("', bankAccountNumber='");
+            append(customer.getBankAccountNumber());
+            append('}');
+        }
+        append('\n');
+    }
+
+    // Passes the buffered text to the stream and flushes it.
+    void flush() {
+        if (used > 0) {
+            out.write(buffer.data(), used);
+            used = 0;
+        }
+        out.flush();
+    }
+};
+
 class CustomerManager {
 private:
+    // Orders customer positions by full name.
+    struct NameOrder {
+        const vector<Customer>* customers;
+
+        bool operator()(size_t a, size_t b) const {
+            return Customer::fullNameLess((*customers)[a], (*customers)[b]);
+        }
+    };
+
+    // Orders customer positions by credit card number; also compares against
+    // plain strings so range bounds can be looked up directly.
+    struct CardOrder {
+        using is_transparent = void;
+        const vector<Customer>* customers;
+
+        bool operator()(size_t a, size_t b) const {
+            return (*customers)[a].getCreditCardNumber() < (*customers)[b].getCreditCardNumber();
+        }
+        bool operator()(size_t a, const string& card) const {
+            return (*customers)[a].getCreditCardNumber() < card;
+        }
+        bool operator()(const string& card, size_t b) const {
+            return card < (*customers)[b].getCreditCardNumber();
+        }
+    };
+
     vector<Customer> customers;
+    multiset<size_t, NameOrder> nameIndex{ NameOrder{ &customers } };
+    multiset<size_t, CardOrder> cardIndex{ CardOrder{ &customers } };
+
+    // Re-inserts already ordered positions; the end hint keeps this linear.
+    template <typename Index, typename Positions>
+    static void copyIndex(const Positions& from, Index& to) {
+        to.clear();
+        for (size_t position : from) {
+            to.insert(to.end(), position);
+        }
+    }
+
+    // Compact sort key: the first eight key bytes, big-endian, plus the position.
+    // Most comparisons are settled by the prefix without touching the customer.
+    struct SortKey {
+        uint64_t prefix;
+        size_t position;
+    };
+
+    // Packs the leading bytes of first, then a space and second when given, into
+    // a zero-padded big-endian integer, so integer order agrees with comparing
+    // the concatenation (the getFullName() layout).
+    static uint64_t keyPrefix(const string& first, const string* second = nullptr) {
+        unsigned char bytes[8] = {};
+        size_t length = min<size_t>(first.size(), 8);
+        memcpy(bytes, first.data(), length);
+        if (second != nullptr && length < 8) {
+            bytes[length] = ' ';
+            memcpy(bytes + length + 1, second->data(), min<size_t>(second->size(), 8 - length - 1));
+        }
+        uint64_t prefix = 0;
+        for (unsigned char byte : bytes) {
+            prefix = (prefix << 8) | byte;
+        }
+        return prefix;
+    }
+
+    // Returns all positions ordered by the three-way compare, ties kept in position order.
+    template <typename Compare, typename Prefix>
+    vector<size_t> sortPositions(Compare compare, Prefix prefixOf, unsigned threadCount) const {
+        vector<SortKey> keys(customers.size());
+        size_t parts = max(1u, threadCount);
+        runInThreads(parts, [&](size_t part) {
+            for (size_t i = keys.size() * part / parts; i < keys.size() * (part + 1) / parts; ++i) {
+                keys[i] = SortKey{ prefixOf(customers[i]), i };
+            }
+        });
+        parallelSort(keys, [&](const SortKey& a, const SortKey& b) {
+            if (a.prefix != b.prefix) {
+                return a.prefix < b.prefix;
+            }
+            int cmp = compare(customers[a.position], customers[b.position]);
+            return cmp != 0 ? cmp < 0 : a.position < b.position;
+        }, threadCount);
+
+        vector<size_t> positions(keys.size());
+        for (size_t i = 0; i < keys.size(); ++i) {
+            positions[i] = keys[i].position;
+        }
+        return positions;
+    }
+
+    vector<size_t> sortPositionsByName(unsigned threadCount) const {
+        return sortPositions(Customer::compareFullName, [](const Customer& customer) {
+            return keyPrefix(customer.getLastName(), &customer.getFirstName());
+        }, threadCount);
+    }
+
+    vector<size_t> sortPositionsByCard(unsigned threadCount) const {
+        auto compareCards = [](const Customer& a, const Customer& b) {
+            return a.getCreditCardNumber().compare(b.getCreditCardNumber());
+        };
+        return sortPositions(compareCards, [](const Customer& customer) {
+            return keyPrefix(customer.getCreditCardNumber());
+        }, threadCount);
+    }
+
+    // Rebuilds both indexes with one sort each instead of one tree insertion per
+    // customer. Ties keep insertion order, as with insert().
+    void rebuildIndexes(unsigned threadCount) {
+        copyIndex(sortPositionsByName(threadCount), nameIndex);
+        copyIndex(sortPositionsByCard(threadCount), cardIndex);
+    }
+
+    // Appends parsed batches in order, then refreshes the indexes once.
+    void appendBatches(vector<vector<Customer>>& batches, unsigned threadCount) {
+        size_t total = customers.size();
+        for (const auto& batch : batches) {
+            total += batch.size();
+        }
+        customers.reserve(total);
+        for (auto& batch : batches) {
+            customers.insert(customers.end(), make_move_iterator(batch.begin()), make_move_iterator(batch.end()));
+        }
+        rebuildIndexes(threadCount);
+    }
+
+    static const char* findByte(const char* begin, const char* end, char byte) {
+        const void* found = memchr(begin, byte, end - begin);
+        return found ? static_cast<const char*>(found) : end;
+    }
+
+    // Start of the line after the one holding begin, or end on the last line
+    static const char* nextLine(const char* begin, const char* end) {
+        const char* lineEnd = findByte(begin, end, '\n');
+        return lineEnd == end ? end : lineEnd + 1;
+    }
+
+    // The first line break at or after begin that is outside quotes, or end.
+    // inQuotes tells whether begin lies inside a quoted field. A doubled quote
+    // closes and reopens the field, which keeps the parity right.
+    static const char* findRecordEnd(const char* begin, const char* end, bool inQuotes = false) {
+        const char* cursor = begin;
+        for (;;) {
+            if (inQuotes) {
+                const char* quote = findByte(cursor, end, '"');
+                if (quote == end) {
+                    return end;
+                }
+                cursor = quote + 1;
+                inQuotes = false;
+            } else {
+                const char* lineEnd = findByte(cursor, end, '\n');
+                const char* quote = findByte(cursor, lineEnd, '"');
+                if (quote == lineEnd) {
+                    return lineEnd;
+                }
+                cursor = quote + 1;
+                inQuotes = true;
+            }
+        }
+    }
+
+    // Reads one CSV field and moves the cursor past it. Quoted fields may hold
+    // commas, doubled quotes and line breaks. Sets more when a comma follows.
+    static string readCsvField(const char*& cursor, const char* end, bool& more) {
+        string value;
+        if (cursor < end && *cursor == '"') {
+            ++cursor;
+            for (;;) {
+                const char* quote = findByte(cursor, end, '"');
+                if (quote == end) {
+                    throw invalid_argument("Unterminated quoted field.");
+                }
+                value.append(cursor, quote);
+                cursor = quote + 1;
+                if (cursor == end || *cursor != '"') {
+                    break;
+                }
+                value += '"';
+                ++cursor;
+            }
+            if (cursor < end && *cursor != ',') {
+                throw invalid_argument("Unexpected character after quoted field.");
+            }
+        } else {
+            const char* comma = findByte(cursor, end, ',');
+            value.assign(cursor, comma);
+            cursor = comma;
+        }
+        more = cursor < end;
+        if (more) {
+            ++cursor;
+        }
+        return value;
+    }
+
+    // Parses id,lastName,firstName,middleName,address,creditCardNumber,bankAccountNumber.
+    static Customer parseCsvRecord(const char* begin, const char* end) {
+        const char* cursor = begin;
+        int id = 0;
+        auto parsed = from_chars(cursor, end, id);
+        if (parsed.ec != errc() || parsed.ptr == end || *parsed.ptr != ',') {
+            throw invalid_argument("Invalid customer id.");
+        }
+        cursor = parsed.ptr + 1;
+
+        string fields[6];
+        bool more = true;
+        for (auto& field : fields) {
+            if (!more) {
+                throw invalid_argument("Missing customer field.");
+            }
+            field = readCsvField(cursor, end, more);
+        }
+        if (more) {
+            throw invalid_argument("Too many customer fields.");
+        }
+        return Customer(id, move(fields[0]), move(fields[1]), move(fields[2]), move(fields[3]),
+                        move(fields[4]), move(fields[5]));
+    }
+
+    // Parses every record in [begin, end), which starts at a record boundary;
+    // fileStart is used for error offsets.
+    static void parseCsvChunk(const char* begin, const char* end, const char* fileStart, vector<Customer>& out) {
+        out.reserve((end - begin) / 96 + 1);
+        while (begin < end) {
+            const char* lineEnd = findRecordEnd(begin, end);
+            const char* contentEnd = (lineEnd > begin && lineEnd[-1] == '\r') ? lineEnd - 1 : lineEnd;
+            if (contentEnd > begin) {
+                try {
+                    out.push_back(parseCsvRecord(begin, contentEnd));
+                } catch (const invalid_argument& e) {
+                    throw invalid_argument("Malformed customer record at byte " +
+                                           to_string(begin - fileStart) + ": " + e.what());
+                }
+            }
+            begin = lineEnd == end ? end : lineEnd + 1;
+        }
+    }
+
+    static const char BinaryMagic[8];
+
+    template <typename T>
+    static T readBinary(const char*& cursor, const char* end) {
+        if (static_cast<size_t>(end - cursor) < sizeof(T)) {
+            throw invalid_argument("Truncated customer binary file.");
+        }
+        T value;
+        memcpy(&value, cursor, sizeof(T));
+        cursor += sizeof(T);
+        return value;
+    }
+
+    static string readBinaryString(const char*& cursor, const char* end) {
+        uint32_t size = readBinary<uint32_t>(cursor, end);
+        if (static_cast<size_t>(end - cursor) < size) {
+            throw invalid_argument("Truncated customer binary file.");
+        }
+        string value(cursor, size);
+        cursor += size;
+        return value;
+    }
+
+    static void writeBinaryString(ostream& out, const string& value) {
+        uint32_t size = static_cast<uint32_t>(value.size());
+        out.write(reinterpret_cast<const char*>(&size), sizeof(size));
+        out.write(value.data(), value.size());
+    }
 
 public:
-    // Adds a new customer to the manager.
+    CustomerManager() = default;
+
+    // The indexes point at this manager's storage, so copies rebuild them.
+    CustomerManager(const CustomerManager& other) : customers(other.customers) {
+        copyIndex(other.nameIndex, nameIndex);
+        copyIndex(other.cardIndex, cardIndex);
+    }
+
+    CustomerManager& operator=(const CustomerManager& other) {
+        if (this != &other) {
+            customers = other.customers;
+            copyIndex(other.nameIndex, nameIndex);
+            copyIndex(other.cardIndex, cardIndex);
+        }
+        return *this;
+    }
+
+    // Adds a new customer to the manager and updates both indexes.
     void addCustomer(const Customer& customer) {
-        customers.push_back(customer);
+        addCustomer(Customer(customer));
     }
 
-    // Prints the list of customers sorted by full name.
-    void printCustomersSorted() {
-        sort(customers.begin(), customers.end(), [](const Customer& a, const Customer& b) {
-            return a.getFullName() < b.getFullName();
-        });
+    // Adds a new customer, taking over its strings.
+    void addCustomer(Customer&& customer) {
+        customers.push_back(move(customer));
+        size_t position = customers.size() - 1;
+        nameIndex.insert(position);
+        cardIndex.insert(position);
+    }
 
-        cout << "Customers in alphabetical order:\n";
+    // Reserves storage for the given total number of customers.
+    void reserve(size_t count) {
+        customers.reserve(count);
+    }
+
+    // Loads customers from a memory-mapped CSV file with one record per line:
+    // id,lastName,firstName,middleName,address,creditCardNumber,bankAccountNumber.
+    // Quoted fields may span lines. A leading "id," header line is skipped. The
+    // file is split at record boundaries into one chunk per thread; finding them
+    // counts the quotes before each split. On a malformed record nothing is added.
+    BulkLoadReport loadCsv(const string& path, unsigned threadCount = 1) {
+        auto start = chrono::steady_clock::now();
+        MappedFile file(path);
+        const char* begin = file.data();
+        const char* end = begin + file.size();
+        if (file.size() >= 3 && memcmp(begin, "id,", 3) == 0) {
+            begin = nextLine(begin, end);
+        }
+
+        threadCount = max(1u, threadCount);
+        vector<const char*> bounds{ begin };
+        for (unsigned i = 1; i < threadCount; ++i) {
+            const char* split = max(bounds.back(), begin + (end - begin) * i / threadCount);
+            bool inQuotes = count(bounds.back(), split, '"') % 2 != 0;
+            split = findRecordEnd(split, end, inQuotes);
+            split = split == end ? end : split + 1;
+            bounds.push_back(split);
+        }
+        bounds.push_back(end);
+
+        vector<vector<Customer>> batches(threadCount);
+        vector<exception_ptr> errors(threadCount);
+        vector<thread> workers;
+        for (unsigned i = 1; i < threadCount; ++i) {
+            workers.emplace_back([&, i] {
+                try {
+                    parseCsvChunk(bounds[i], bounds[i + 1], file.data(), batches[i]);
+                } catch (...) {
+                    errors[i] = current_exception();
+                }
+            });
+        }
+        try {
+            parseCsvChunk(bounds[0], bounds[1], file.data(), batches[0]);
+        } catch (...) {
+            errors[0] = current_exception();
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        for (const auto& error : errors) {
+            if (error) {
+                rethrow_exception(error);
+            }
+        }
+
+        size_t rows = 0;
+        for (const auto& batch : batches) {
+            rows += batch.size();
+        }
+        appendBatches(batches, threadCount);
+        chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+        return BulkLoadReport{ rows, elapsed.count() };
+    }
+
+    // Writes all customers in the compact binary format read by loadBinary:
+    // an 8-byte magic and a 64-bit record count, then per record a 32-bit id
+    // followed by six length-prefixed strings.
+    void saveBinary(const string& path) const {
+        ofstream out(path, ios::binary);
+        if (!out) {
+            throw runtime_error("Cannot open file: " + path);
+        }
+        uint64_t count = customers.size();
+        out.write(BinaryMagic, sizeof(BinaryMagic));
+        out.write(reinterpret_cast<const char*>(&count), sizeof(count));
         for (const auto& customer : customers) {
-            cout << customer << endl;
+            int32_t id = customer.getId();
+            out.write(reinterpret_cast<const char*>(&id), sizeof(id));
+            writeBinaryString(out, customer.getLastName());
+            writeBinaryString(out, customer.getFirstName());
+            writeBinaryString(out, customer.getMiddleName());
+            writeBinaryString(out, customer.getAddress());
+            writeBinaryString(out, customer.getCreditCardNumber());
+            writeBinaryString(out, customer.getBankAccountNumber());
+        }
+        if (!out) {
+            throw runtime_error("Cannot write file: " + path);
+        }
+    }
+
+    // Loads customers from a memory-mapped file written by saveBinary; the
+    // threads are used to rebuild the indexes. On a truncated or foreign file
+    // nothing is added.
+    BulkLoadReport loadBinary(const string& path, unsigned threadCount = 1) {
+        auto start = chrono::steady_clock::now();
+        MappedFile file(path);
+        const char* cursor = file.data();
+        const char* end = cursor + file.size();
+        if (file.size() < sizeof(BinaryMagic) || memcmp(cursor, BinaryMagic, sizeof(BinaryMagic)) != 0) {
+            throw invalid_argument("Not a customer binary file: " + path);
+        }
+        cursor += sizeof(BinaryMagic);
+        uint64_t count = readBinary<uint64_t>(cursor, end);
+        // Every record takes at least 28 bytes, which bounds the reservation.
+        if (count > static_cast<uint64_t>(end - cursor) / 28) {
+            throw invalid_argument("Truncated customer binary file.");
+        }
+
+        vector<vector<Customer>> batches(1);
+        batches[0].reserve(count);
+        for (uint64_t i = 0; i < count; ++i) {
+            int id = readBinary<int32_t>(cursor, end);
+            string lastName = readBinaryString(cursor, end);
+            string firstName = readBinaryString(cursor, end);
+            string middleName = readBinaryString(cursor, end);
+            string address = readBinaryString(cursor, end);
+            string creditCardNumber = readBinaryString(cursor, end);
+            string bankAccountNumber = readBinaryString(cursor, end);
+            batches[0].emplace_back(id, move(lastName), move(firstName), move(middleName), move(address),
+                                    move(creditCardNumber), move(bankAccountNumber));
+        }
+        appendBatches(batches, max(1u, threadCount));
+        chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+        return BulkLoadReport{ count, elapsed.count() };
+    }
+
+    // Returns the number of stored customers.
+    size_t size() const {
+        return customers.size();
+    }
+
+    // Returns all customers ordered by full name, read straight from the name index.
+    vector<const Customer*> getCustomersSorted() const {
+        vector<const Customer*> result;
+        result.reserve(nameIndex.size());
+        for (size_t position : nameIndex) {
+            result.push_back(&customers[position]);
         }
+        return result;
+    }
+
+    // Returns one page of the name-ordered listing, read from the name index
+    // in O(offset + count) without sorting anything.
+    vector<const Customer*> getCustomersPage(size_t offset, size_t count) const {
+        vector<const Customer*> page;
+        if (offset >= nameIndex.size()) {
+            return page;
+        }
+        page.reserve(min(count, nameIndex.size() - offset));
+        auto it = nameIndex.begin();
+        advance(it, offset);
+        for (; it != nameIndex.end() && page.size() < count; ++it) {
+            page.push_back(&customers[*it]);
+        }
+        return page;
+    }
+
+    // Reorders the stored customers into name order using a parallel sort of
+    // compact keys, so sorted listings afterwards read memory sequentially.
+    void sortByName(unsigned threadCount = 1) {
+        threadCount = max(1u, threadCount);
+        vector<size_t> order = sortPositionsByName(threadCount);
+        vector<Customer> sorted;
+        sorted.reserve(customers.size());
+        for (size_t position : order) {
+            sorted.push_back(move(customers[position]));
+        }
+        customers.swap(sorted);
+        iota(order.begin(), order.end(), 0);
+        copyIndex(order, nameIndex);
+        copyIndex(sortPositionsByCard(threadCount), cardIndex);
+    }
+
+    // Returns customers whose credit card number lies in [startRange, endRange],
+    // ordered by card number, in O(log n + k).
+    vector<const Customer*> findByCreditCardRange(const string& startRange, const string& endRange) const {
+        vector<const Customer*> result;
+        if (endRange < startRange) {
+            return result;
+        }
+        auto last = cardIndex.upper_bound(endRange);
+        for (auto it = cardIndex.lower_bound(startRange); it != last; ++it) {
+            result.push_back(&customers[*it]);
+        }
+        return result;
+    }
+
+    // Writes all customers ordered by full name.
+    void writeCustomersSorted(CustomerReportWriter& writer) const {
+        for (size_t position : nameIndex) {
+            writer.write(customers[position]);
+        }
+    }
+
+    // Writes customers with credit card numbers within a specified range.
+    void writeCustomersByCreditCardRange(CustomerReportWriter& writer, const string& startRange,
+                                         const string& endRange) const {
+        if (endRange < startRange) {
+            return;
+        }
+        auto last = cardIndex.upper_bound(endRange);
+        for (auto it = cardIndex.lower_bound(startRange); it != last; ++it) {
+            writer.write(customers[*it]);
+        }
+    }
+
+    // Prints the list of customers sorted by full name.
+    void printCustomersSorted() const {
+        CustomerReportWriter writer(cout);
+        writer.writeLine("Customers in alphabetical order:");
+        writeCustomersSorted(writer);
     }
 
     // Prints customers with credit card numbers within a specified range.
-    void printCustomersByCreditCardRange(const string& startRange, const string& endRange) {
-        cout << "Customers with credit card numbers in the range:\n";
-        for (const auto& customer : customers) {
-            const string& cardNumber = customer.getCreditCardNumber();
-            if (cardNumber >= startRange && cardNumber <= endRange) {
-                cout << customer << endl;
+    void printCustomersByCreditCardRange(const string& startRange, const string& endRange) const {
+        CustomerReportWriter writer(cout);
+        writer.writeLine("Customers with credit card numbers in the range:");
+        writeCustomersByCreditCardRange(writer, startRange, endRange);
+    }
+};
+
+const char CustomerManager::BinaryMagic[8] = { 'C', 'U', 'S', 'T', 'B', 'I', 'N', '1' };
+
+// Column-oriented customer storage. Every field lives in its own contiguous
+// array: names and addresses are kept in one shared string arena (names are
+// interned, so repeated first and last names are stored once), and card and
+// account numbers are zero-padded fixed-width columns. A filter on one field
+// only streams through that field's column.
+class CustomerStore {
+public:
+    static constexpr size_t CardWidth = 19;     // Longest card number (ISO/IEC 7812)
+    static constexpr size_t AccountWidth = 34;  // Longest account number (IBAN)
+
+private:
+    enum NameField { LastName, FirstName, MiddleName, NameFieldCount };
+
+    vector<int> ids;
+    vector<uint32_t> names;        // NameFieldCount string ids per row
+    vector<uint32_t> addresses;    // One string id per row
+    vector<char> cards;            // CardWidth bytes per row
+    vector<char> accounts;         // AccountWidth bytes per row
+
+    string arena;                  // Bytes of every stored string
+    vector<uint32_t> stringStarts{ 0 }; // String id i spans [stringStarts[i], stringStarts[i + 1])
+    vector<uint32_t> internSlots;  // Open-addressing table of string id + 1, 0 marks a free slot
+    size_t internedCount = 0;
+
+    static size_t hashBytes(const char* data, size_t length) {
+        size_t hash = 14695981039346656037ull; // FNV-1a
+        for (size_t i = 0; i < length; ++i) {
+            hash = (hash ^ static_cast<unsigned char>(data[i])) * 1099511628211ull;
+        }
+        return hash;
+    }
+
+    uint32_t appendString(const string& value) {
+        if (arena.size() + value.size() > UINT32_MAX) {
+            throw length_error("Customer string arena is full.");
+        }
+        stringStarts.reserve(stringStarts.size() + 1); // So the push_back below cannot throw
+        arena += value;
+        stringStarts.push_back(static_cast<uint32_t>(arena.size()));
+        return static_cast<uint32_t>(stringStarts.size() - 2);
+    }
+
+    bool stringEquals(uint32_t stringId, const string& value) const {
+        size_t start = stringStarts[stringId];
+        return stringStarts[stringId + 1] - start == value.size() &&
+               memcmp(arena.data() + start, value.data(), value.size()) == 0;
+    }
+
+    void growInternTable() {
+        vector<uint32_t> slots(internSlots.empty() ? 1024 : internSlots.size() * 2, 0);
+        size_t mask = slots.size() - 1;
+        for (uint32_t slot : internSlots) {
+            if (slot == 0) {
+                continue;
+            }
+            uint32_t stringId = slot - 1;
+            size_t start = stringStarts[stringId];
+            size_t i = hashBytes(arena.data() + start, stringStarts[stringId + 1] - start) & mask;
+            while (slots[i] != 0) {
+                i = (i + 1) & mask;
+            }
+            slots[i] = slot;
+        }
+        internSlots.swap(slots);
+    }
+
+    // Returns the id of an equal string already in the arena, appending it if new.
+    uint32_t intern(const string& value) {
+        if ((internedCount + 1) * 2 > internSlots.size()) {
+            growInternTable();
+        }
+        size_t mask = internSlots.size() - 1;
+        size_t i = hashBytes(value.data(), value.size()) & mask;
+        while (internSlots[i] != 0) {
+            if (stringEquals(internSlots[i] - 1, value)) {
+                return internSlots[i] - 1;
             }
+            i = (i + 1) & mask;
         }
+        uint32_t stringId = appendString(value);
+        internSlots[i] = stringId + 1;
+        ++internedCount;
+        return stringId;
+    }
+
+    string stringAt(uint32_t stringId) const {
+        size_t start = stringStarts[stringId];
+        return arena.substr(start, stringStarts[stringId + 1] - start);
+    }
+
+    // Writes value zero-padded to width bytes. Zero padding keeps memcmp order
+    // identical to string order, since a shorter prefix sorts first either way.
+    static void encodeFixed(const string& value, size_t width, char* out, const char* field) {
+        if (value.size() > width) {
+            throw invalid_argument(string(field) + " is too long.");
+        }
+        memcpy(out, value.data(), value.size());
+        memset(out + value.size(), 0, width - value.size());
+    }
+
+    static string decodeFixed(const char* data, size_t width) {
+        return string(data, strnlen(data, width));
+    }
+
+public:
+    // Reserves space for the given number of customers in every column.
+    void reserve(size_t count) {
+        ids.reserve(count);
+        names.reserve(count * NameFieldCount);
+        addresses.reserve(count);
+        cards.reserve(count * CardWidth);
+        accounts.reserve(count * AccountWidth);
+    }
+
+    // Appends a customer, splitting its fields into the columns. If any step
+    // throws, every column is truncated back so the rows stay aligned; strings
+    // already added to the arena are left unreferenced.
+    void addCustomer(const Customer& customer) {
+        size_t row = ids.size();
+        try {
+            cards.resize(cards.size() + CardWidth);
+            accounts.resize(accounts.size() + AccountWidth);
+            encodeFixed(customer.getCreditCardNumber(), CardWidth, &cards[row * CardWidth], "Credit card number");
+            encodeFixed(customer.getBankAccountNumber(), AccountWidth, &accounts[row * AccountWidth], "Bank account number");
+            names.push_back(intern(customer.getLastName()));
+            names.push_back(intern(customer.getFirstName()));
+            names.push_back(intern(customer.getMiddleName()));
+            addresses.push_back(appendString(customer.getAddress()));
+            ids.push_back(customer.getId());
+        } catch (...) {
+            ids.resize(row);
+            names.resize(row * NameFieldCount);
+            addresses.resize(row);
+            cards.resize(row * CardWidth);
+            accounts.resize(row * AccountWidth);
+            throw;
+        }
+    }
+
+    // Returns the number of stored customers.
+    size_t size() const {
+        return ids.size();
+    }
+
+    // Rebuilds the customer stored at the given row.
+    Customer getCustomer(size_t row) const {
+        if (row >= ids.size()) {
+            throw out_of_range("Row is out of range.");
+        }
+        const uint32_t* rowNames = &names[row * NameFieldCount];
+        return Customer(ids[row], stringAt(rowNames[LastName]), stringAt(rowNames[FirstName]),
+                        stringAt(rowNames[MiddleName]), stringAt(addresses[row]),
+                        decodeFixed(&cards[row * CardWidth], CardWidth),
+                        decodeFixed(&accounts[row * AccountWidth], AccountWidth));
+    }
+
+    // Returns the rows whose credit card number lies in [startRange, endRange].
+    // Only the card column is read.
+    vector<size_t> findByCreditCardRange(const string& startRange, const string& endRange) const {
+        char low[CardWidth];
+        char high[CardWidth];
+        encodeFixed(startRange, CardWidth, low, "Range start");
+        encodeFixed(endRange, CardWidth, high, "Range end");
+
+        vector<size_t> rows;
+        const char* card = cards.data();
+        for (size_t row = 0; row < ids.size(); ++row, card += CardWidth) {
+            if (memcmp(card, low, CardWidth) >= 0 && memcmp(card, high, CardWidth) <= 0) {
+                rows.push_back(row);
+            }
+        }
+        return rows;
+    }
+
+    // Returns the number of distinct strings held in the arena.
+    size_t stringCount() const {
+        return stringStarts.size() - 1;
+    }
+
+    // Returns the heap bytes held by all columns and the arena.
+    size_t memoryFootprint() const {
+        return ids.capacity() * sizeof(int) + names.capacity() * sizeof(uint32_t) +
+               addresses.capacity() * sizeof(uint32_t) + cards.capacity() + accounts.capacity() +
+               arena.capacity() + stringStarts.capacity() * sizeof(uint32_t) +
+               internSlots.capacity() * sizeof(uint32_t);
     }
 };
 
@@ -159,8 +1193,594 @@ void testAddCustomer() {
     assert(customer1.getFullName() == "Smith John");
 }
 
-// Main function to run tests
-int main() {
+void testSortedIndex() {
+    CustomerManager manager;
+    manager.addCustomer(Customer(1, "Smith", "John"));
+    manager.addCustomer(Customer(2, "Doe", "Jane"));
+    manager.addCustomer(Customer(3, "Smith", "Anna"));
+    manager.addCustomer(Customer(4, "Adams", "Bob"));
+
+    vector<const Customer*> sorted = manager.getCustomersSorted();
+    assert(sorted.size() == 4);
+    assert(sorted[0]->getFullName() == "Adams Bob");
+    assert(sorted[1]->getFullName() == "Doe Jane");
+    assert(sorted[2]->getFullName() == "Smith Anna");
+    assert(sorted[3]->getFullName() == "Smith John");
+
+    // The index is kept up to date on every insertion.
+    manager.addCustomer(Customer(5, "Baker", "Carl"));
+    sorted = manager.getCustomersSorted();
+    assert(sorted.size() == 5);
+    assert(sorted[1]->getFullName() == "Baker Carl");
+}
+
+void testCreditCardRangeIndex() {
+    CustomerManager manager;
+    manager.addCustomer(Customer(1, "Smith", "John", "", "", "4000", ""));
+    manager.addCustomer(Customer(2, "Doe", "Jane", "", "", "1000", ""));
+    manager.addCustomer(Customer(3, "Lee", "Ann", "", "", "3000", ""));
+    manager.addCustomer(Customer(4, "Kim", "Bo", "", "", "2000", ""));
+    manager.addCustomer(Customer(5, "Ray", "Al", "", "", "3000", ""));
+
+    vector<const Customer*> found = manager.findByCreditCardRange("2000", "3000");
+    assert(found.size() == 3);
+    assert(found[0]->getCreditCardNumber() == "2000");
+    assert(found[1]->getCreditCardNumber() == "3000");
+    assert(found[2]->getCreditCardNumber() == "3000");
+
+    assert(manager.findByCreditCardRange("5000", "9000").empty());
+    assert(manager.findByCreditCardRange("3000", "2000").empty()); // Inverted range
+}
+
+void testManagerCopyKeepsIndexes() {
+    CustomerManager manager;
+    manager.addCustomer(Customer(1, "Smith", "John", "", "", "2000", ""));
+    manager.addCustomer(Customer(2, "Doe", "Jane", "", "", "1000", ""));
+
+    CustomerManager copy(manager);
+    copy.addCustomer(Customer(3, "Adams", "Bob", "", "", "1500", ""));
+
+    assert(manager.size() == 2);
+    assert(copy.size() == 3);
+    assert(copy.getCustomersSorted()[0]->getFullName() == "Adams Bob");
+    assert(copy.findByCreditCardRange("1000", "1999").size() == 2);
+    assert(manager.findByCreditCardRange("1000", "1999").size() == 1);
+}
+
+void testCustomerStoreRoundTrip() {
+    CustomerStore store;
+    store.addCustomer(Customer(1, "Smith", "John", "A.", "123 Main St", "1234567890123456", "111222333"));
+    store.addCustomer(Customer(2, "Doe", "Jane"));
+
+    assert(store.size() == 2);
+    Customer first = store.getCustomer(0);
+    assert(first.getId() == 1);
+    assert(first.getFullName() == "Smith John");
+    assert(first.getMiddleName() == "A.");
+    assert(first.getAddress() == "123 Main St");
+    assert(first.getCreditCardNumber() == "1234567890123456");
+    assert(first.getBankAccountNumber() == "111222333");
+
+    Customer second = store.getCustomer(1);
+    assert(second.getFullName() == "Doe Jane");
+    assert(second.getCreditCardNumber() == "");
+
+    try {
+        store.getCustomer(2);
+        assert(false); // Should not reach here
+    } catch (const out_of_range& e) {
+        assert(true); // Expected exception
+    }
+}
+
+void testCustomerStoreInterning() {
+    CustomerStore store;
+    store.addCustomer(Customer(1, "Smith", "John", "", "1 Main St", "", ""));
+    store.addCustomer(Customer(2, "Smith", "Jane", "", "2 Main St", "", ""));
+    store.addCustomer(Customer(3, "Doe", "John", "", "3 Main St", "", ""));
+
+    // "Smith", "John", "", "Jane", "Doe" plus three addresses
+    assert(store.stringCount() == 8);
+    assert(store.getCustomer(2).getFullName() == "Doe John");
+    assert(store.getCustomer(1).getAddress() == "2 Main St");
+}
+
+void testCustomerStoreCreditCardRange() {
+    CustomerStore store;
+    store.addCustomer(Customer(1, "Smith", "John", "", "", "4000", ""));
+    store.addCustomer(Customer(2, "Doe", "Jane", "", "", "1000", ""));
+    store.addCustomer(Customer(3, "Lee", "Ann", "", "", "300", ""));
+    store.addCustomer(Customer(4, "Kim", "Bo", "", "", "2000", ""));
+    store.addCustomer(Customer(5, "Ray", "Al", "", "", "3000", ""));
+
+    // Same string ordering as CustomerManager: "300" lies between "2000" and "3000".
+    vector<size_t> rows = store.findByCreditCardRange("2000", "3000");
+    assert(rows.size() == 3);
+    assert(rows[0] == 2);
+    assert(rows[1] == 3);
+    assert(rows[2] == 4);
+    assert(store.findByCreditCardRange("5000", "9000").empty());
+}
+
+void testCustomerStoreCardTooLong() {
+    CustomerStore store;
+    try {
+        store.addCustomer(Customer(1, "Smith", "John", "", "", "12345678901234567890", ""));
+        assert(false); // Should not reach here
+    } catch (const invalid_argument& e) {
+        assert(true); // Expected exception
+    }
+    assert(store.size() == 0);
+    store.addCustomer(Customer(2, "Doe", "Jane", "", "", "1000", ""));
+    assert(store.getCustomer(0).getCreditCardNumber() == "1000");
+
+    // A failure after the card is written leaves every column as it was
+    try {
+        store.addCustomer(Customer(3, "Adams", "Bob", "", "1 Main St", "2000", string(64, '9')));
+        assert(false); // Should not reach here
+    } catch (const invalid_argument& e) {
+        assert(true); // Expected exception
+    }
+    store.addCustomer(Customer(4, "Baker", "Carl", "B.", "2 Elm St", "3000", "444"));
+    assert(store.size() == 2);
+    Customer added = store.getCustomer(1);
+    assert(added.getId() == 4);
+    assert(added.getFullName() == "Baker Carl");
+    assert(added.getAddress() == "2 Elm St");
+    assert(added.getCreditCardNumber() == "3000");
+    assert(added.getBankAccountNumber() == "444");
+}
+
+void testLoadCsv() {
+    const string path = "customers_test.csv";
+    {
+        ofstream out(path, ios::binary);
+        out << "id,lastName,firstName,middleName,address,creditCardNumber,bankAccountNumber\n"
+            << "1,Smith,John,A.,123 Main St,1234567890123456,111222333\r\n"
+            << "\n"
+            << "2,Doe,Jane,,\"45 Elm St, Apt \"\"B\"\"\",2000,444\n"
+            << "3,Adams,Bob,,,1500,";
+    }
+
+    CustomerManager manager;
+    manager.addCustomer(Customer(7, "Zed", "Zoe", "", "", "9000", ""));
+    BulkLoadReport report = manager.loadCsv(path);
+    remove(path.c_str());
+
+    assert(report.rows == 3);
+    assert(manager.size() == 4);
+    vector<const Customer*> sorted = manager.getCustomersSorted();
+    assert(sorted[0]->getFullName() == "Adams Bob");
+    assert(sorted[0]->getBankAccountNumber() == "");
+    assert(sorted[1]->getAddress() == "45 Elm St, Apt \"B\"");
+    assert(sorted[2]->getBankAccountNumber() == "111222333");
+    assert(sorted[3]->getFullName() == "Zed Zoe");
+    assert(manager.findByCreditCardRange("1500", "2000").size() == 2);
+}
+
+void testLoadCsvParallel() {
+    const string path = "customers_parallel_test.csv";
+    {
+        ofstream out(path, ios::binary);
+        for (int i = 0; i < 1000; ++i) {
+            out << i << ",Last" << (i * 7919) % 1000 << ",First,,Street " << i << "," << 100000 + i << ",\n";
+        }
+    }
+
+    CustomerManager sequential;
+    CustomerManager parallel;
+    sequential.loadCsv(path, 1);
+    BulkLoadReport report = parallel.loadCsv(path, 7);
+    remove(path.c_str());
+
+    assert(report.rows == 1000);
+    vector<const Customer*> expected = sequential.getCustomersSorted();
+    vector<const Customer*> actual = parallel.getCustomersSorted();
+    assert(actual.size() == expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        assert(actual[i]->getId() == expected[i]->getId());
+    }
+}
+
+void testLoadCsvMalformed() {
+    const string path = "customers_malformed_test.csv";
+    {
+        ofstream out(path, ios::binary);
+        out << "1,Smith,John,,,1000,\n"
+            << "x,Doe,Jane,,,2000,\n";
+    }
+
+    CustomerManager manager;
+    try {
+        manager.loadCsv(path);
+        assert(false); // Should not reach here
+    } catch (const invalid_argument& e) {
+        assert(string(e.what()).find("byte 21") != string::npos); // Expected exception
+    }
+    remove(path.c_str());
+    assert(manager.size() == 0);
+}
+
+void testLoadMissingFile() {
+    CustomerManager manager;
+    try {
+        manager.loadCsv("no_such_customers.csv");
+        assert(false); // Should not reach here
+    } catch (const runtime_error& e) {
+        assert(true); // Expected exception
+    }
+}
+
+void testBinaryRoundTrip() {
+    const string path = "customers_test.bin";
+    CustomerManager original;
+    original.addCustomer(Customer(1, "Smith", "John", "A.", "123 Main St", "1234567890123456", "111222333"));
+    original.addCustomer(Customer(2, "Doe", "Jane"));
+    original.saveBinary(path);
+
+    CustomerManager loaded;
+    BulkLoadReport report = loaded.loadBinary(path);
+    remove(path.c_str());
+
+    assert(report.rows == 2);
+    vector<const Customer*> sorted = loaded.getCustomersSorted();
+    assert(sorted.size() == 2);
+    assert(sorted[0]->getFullName() == "Doe Jane");
+    assert(sorted[1]->getAddress() == "123 Main St");
+    assert(sorted[1]->getBankAccountNumber() == "111222333");
+
+    try {
+        loaded.loadBinary("customers_test.bin");
+        assert(false); // Should not reach here
+    } catch (const runtime_error& e) {
+        assert(true); // Expected exception, the file was removed
+    }
+}
+
+void testReportWriterText() {
+    Customer customer1(1, "Smith", "John", "A.", "123 Main St", "1234567890123456", "111222333");
+    Customer customer2(-2, "Doe", "Jane");
+    ostringstream expected;
+    expected << customer1 << "\n" << customer2 << "\n";
+
+    // A tiny buffer forces flushes in the middle of records.
+    ostringstream actual;
+    {
+        CustomerReportWriter writer(actual, ReportFormat::Text, 16);
+        writer.write(customer1);
+        writer.write(customer2);
+    }
+    assert(actual.str() == expected.str());
+}
+
+void testReportWriterCsv() {
+    ostringstream actual;
+    {
+        CustomerReportWriter writer(actual, ReportFormat::Csv);
+        writer.writeLine("id,lastName,firstName,middleName,address,creditCardNumber,bankAccountNumber");
+        writer.write(Customer(1, "Smith", "John", "A.", "123 Main St", "1234567890123456", "111222333"));
+        writer.write(Customer(2, "Doe", "Jane", "", "45 Elm St, Apt \"B\"", "", ""));
+    }
+    assert(actual.str() == "id,lastName,firstName,middleName,address,creditCardNumber,bankAccountNumber\n"
+                           "1,Smith,John,A.,123 Main St,1234567890123456,111222333\n"
+                           "2,Doe,Jane,,\"45 Elm St, Apt \"\"B\"\"\",,\n");
+}
+
+void testReportCsvRoundTrip() {
+    const string path = "customers_report_test.csv";
+    CustomerManager original;
+    original.addCustomer(Customer(1, "Smith", "John", "A.", "1 Main St, Apt 2", "2000", "111"));
+    original.addCustomer(Customer(2, "Doe", "Jane", "", "", "1000", ""));
+    {
+        ofstream out(path, ios::binary);
+        CustomerReportWriter writer(out, ReportFormat::Csv);
+        original.writeCustomersSorted(writer);
+    }
+
+    CustomerManager loaded;
+    loaded.loadCsv(path);
+    remove(path.c_str());
+    vector<const Customer*> sorted = loaded.getCustomersSorted();
+    assert(sorted.size() == 2);
+    assert(sorted[0]->getFullName() == "Doe Jane");
+    assert(sorted[1]->getAddress() == "1 Main St, Apt 2");
+
+    // Quoted line breaks survive the round trip, also when a thread split
+    // lands inside a quoted field
+    CustomerManager multiline;
+    for (int i = 0; i < 200; ++i) {
+        multiline.addCustomer(Customer(i, "Name" + to_string(i), "First", "",
+                                       "Line 1\nLine \"2\"\r\n" + string(i % 7, ','), to_string(1000 + i), ""));
+    }
+    {
+        ofstream out(path, ios::binary);
+        CustomerReportWriter writer(out, ReportFormat::Csv);
+        multiline.writeCustomersSorted(writer);
+    }
+    for (unsigned threads : { 1u, 3u, 8u }) {
+        CustomerManager reloaded;
+        reloaded.loadCsv(path, threads);
+        vector<const Customer*> expected = multiline.getCustomersSorted();
+        vector<const Customer*> actual = reloaded.getCustomersSorted();
+        assert(actual.size() == expected.size());
+        for (size_t i = 0; i < actual.size(); ++i) {
+            assert(actual[i]->getId() == expected[i]->getId());
+            assert(actual[i]->getAddress() == expected[i]->getAddress());
+        }
+    }
+    remove(path.c_str());
+}
+
+void testPrintCustomersByCreditCardRange() {
+    CustomerManager manager;
+    Customer customer1(1, "Smith", "John", "", "", "2000", "");
+    Customer customer2(2, "Doe", "Jane", "", "", "1000", "");
+    manager.addCustomer(customer1);
+    manager.addCustomer(customer2);
+
+    ostringstream oss;
+    streambuf* oldCout = cout.rdbuf(oss.rdbuf());
+    manager.printCustomersByCreditCardRange("1500", "2500");
+    cout.rdbuf(oldCout);
+
+    ostringstream expected;
+    expected << "Customers with credit card numbers in the range:\n" << customer1 << "\n";
+    assert(oss.str() == expected.str());
+}
+
+void testCustomersPage() {
+    CustomerManager manager;
+    manager.addCustomer(Customer(1, "Smith", "John"));
+    manager.addCustomer(Customer(2, "Doe", "Jane"));
+    manager.addCustomer(Customer(3, "Adams", "Bob"));
+
+    vector<const Customer*> page = manager.getCustomersPage(0, 2);
+    assert(page.size() == 2);
+    assert(page[0]->getFullName() == "Adams Bob");
+    assert(page[1]->getFullName() == "Doe Jane");
+
+    page = manager.getCustomersPage(2, 2);
+    assert(page.size() == 1);
+    assert(page[0]->getFullName() == "Smith John");
+    assert(manager.getCustomersPage(3, 2).empty());
+}
+
+void testSortByName() {
+    CustomerManager manager;
+    // Long shared prefixes and a last name that is a prefix of another one
+    // exercise the fallback from the packed key to the full comparison.
+    manager.addCustomer(Customer(1, "Smithson", "Zed", "", "", "3000", ""));
+    manager.addCustomer(Customer(2, "Smith", "Zed", "", "", "1000", ""));
+    manager.addCustomer(Customer(3, "Smithsonian", "Amy", "", "", "2000", ""));
+    manager.addCustomer(Customer(4, "Smith", "Zed", "", "", "1000", ""));
+    manager.addCustomer(Customer(5, "Smithson", "Abe", "", "", "1500", ""));
+    vector<int> expectedIds;
+    for (const Customer* customer : manager.getCustomersSorted()) {
+        expectedIds.push_back(customer->getId());
+    }
+
+    manager.sortByName(3);
+    vector<const Customer*> sorted = manager.getCustomersSorted();
+    assert(sorted.size() == expectedIds.size());
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        assert(sorted[i]->getId() == expectedIds[i]);
+    }
+    assert(manager.findByCreditCardRange("1000", "1000").size() == 2);
+    assert(manager.findByCreditCardRange("1000", "1000")[0]->getId() == 2);
+
+    // Last names with spaces order exactly like getFullName()
+    Customer spaced(1, "A B", "C"), plain(2, "A", "Z");
+    assert((Customer::compareFullName(spaced, plain) < 0) == (spaced.getFullName() < plain.getFullName()));
+    CustomerManager names;
+    names.addCustomer(plain);
+    names.addCustomer(spaced);
+    names.addCustomer(Customer(3, "A", ""));
+    names.addCustomer(Customer(4, "A!", "B"));
+    names.sortByName(2);
+    sorted = names.getCustomersSorted();
+    for (size_t i = 1; i < sorted.size(); ++i) {
+        assert(sorted[i - 1]->getFullName() <= sorted[i]->getFullName());
+    }
+}
+
+void testParallelSort() {
+    vector<int> values(100000);
+    uint32_t state = 12345;
+    for (auto& value : values) {
+        state = state * 1103515245 + 12345;
+        value = static_cast<int>(state >> 8);
+    }
+    vector<int> expected = values;
+    sort(expected.begin(), expected.end());
+    for (unsigned threads : { 1u, 2u, 3u, 8u }) {
+        vector<int> actual = values;
+        parallelSort(actual, less<int>(), threads);
+        assert(actual == expected);
+    }
+}
+
+// Benchmarks
+
+// Generates customers with realistic name repetition and 16-digit card numbers.
+vector<Customer> makeBenchmarkCustomers(size_t count) {
+    static const char* lastNames[] = { "Smith", "Johnson", "Williams", "Brown", "Jones", "Garcia", "Miller", "Davis" };
+    static const char* firstNames[] = { "James", "Mary", "Robert", "Patricia", "John", "Jennifer", "Michael", "Linda" };
+    vector<Customer> customers;
+    customers.reserve(count);
+    uint64_t state = 88172645463325252ull;
+    for (size_t i = 0; i < count; ++i) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        string card = to_string(4000000000000000ull + state % 1000000000000000ull);
+        customers.emplace_back(static_cast<int>(i), lastNames[state % 8], firstNames[(state >> 8) % 8],
+                               "", to_string(i % 1000) + " Main Street, Springfield", card,
+                               "DE" + to_string(10000000000000000ull + i));
+    }
+    return customers;
+}
+
+// Heap bytes of a string, zero while it fits the small-string buffer.
+size_t stringHeapBytes(const string& value) {
+    string empty;
+    return value.capacity() > empty.capacity() ? value.capacity() + 1 : 0;
+}
+
+void benchmarkCustomerStore() {
+    const size_t count = 1000000;
+    const string low = "4100000000000000";
+    const string high = "4300000000000000";
+    vector<Customer> customers = makeBenchmarkCustomers(count);
+
+    size_t aosBytes = customers.capacity() * sizeof(Customer);
+    for (const auto& customer : customers) {
+        aosBytes += stringHeapBytes(customer.getLastName()) + stringHeapBytes(customer.getFirstName()) +
+                    stringHeapBytes(customer.getMiddleName()) + stringHeapBytes(customer.getAddress()) +
+                    stringHeapBytes(customer.getCreditCardNumber()) + stringHeapBytes(customer.getBankAccountNumber());
+    }
+
+    CustomerStore store;
+    store.reserve(count);
+    for (const auto& customer : customers) {
+        store.addCustomer(customer);
+    }
+
+    auto start = chrono::steady_clock::now();
+    size_t aosMatches = 0;
+    for (const auto& customer : customers) {
+        const string& cardNumber = customer.getCreditCardNumber();
+        if (cardNumber >= low && cardNumber <= high) {
+            ++aosMatches;
+        }
+    }
+    chrono::duration<double> aosTime = chrono::steady_clock::now() - start;
+
+    start = chrono::steady_clock::now();
+    size_t soaMatches = store.findByCreditCardRange(low, high).size();
+    chrono::duration<double> soaTime = chrono::steady_clock::now() - start;
+
+    assert(aosMatches == soaMatches);
+    cout << "CustomerStore benchmark, " << count << " customers:\n"
+         << "  memory: AoS " << aosBytes / (1 << 20) << " MiB, columnar "
+         << store.memoryFootprint() / (1 << 20) << " MiB\n"
+         << "  card range scan: AoS " << count / aosTime.count() / 1e6 << " M rows/s, columnar "
+         << count / soaTime.count() / 1e6 << " M rows/s (" << soaMatches << " matches)" << endl;
+}
+
+// Writes customers as CSV, quoting the addresses since they contain commas.
+void writeBenchmarkCsv(const string& path, const vector<Customer>& customers) {
+    ofstream out(path, ios::binary);
+    for (const auto& customer : customers) {
+        out << customer.getId() << ',' << customer.getLastName() << ',' << customer.getFirstName() << ','
+            << customer.getMiddleName() << ",\"" << customer.getAddress() << "\"," << customer.getCreditCardNumber()
+            << ',' << customer.getBankAccountNumber() << '\n';
+    }
+}
+
+void benchmarkBulkLoad() {
+    const size_t count = 1000000;
+    const string csvPath = "customers_benchmark.csv";
+    const string binaryPath = "customers_benchmark.bin";
+    vector<Customer> customers = makeBenchmarkCustomers(count);
+    writeBenchmarkCsv(csvPath, customers);
+
+    auto start = chrono::steady_clock::now();
+    CustomerManager baseline;
+    for (const auto& customer : customers) {
+        baseline.addCustomer(customer);
+    }
+    chrono::duration<double> baselineTime = chrono::steady_clock::now() - start;
+    baseline.saveBinary(binaryPath);
+
+    cout << "Bulk load benchmark, " << count << " customers:\n"
+         << "  addCustomer loop: " << count / baselineTime.count() / 1e6 << " M rows/s\n";
+    unsigned maxThreads = max(1u, thread::hardware_concurrency());
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+        CustomerManager manager;
+        BulkLoadReport report = manager.loadCsv(csvPath, threads);
+        cout << "  loadCsv, " << threads << " thread(s): " << report.rowsPerSecond() / 1e6 << " M rows/s\n";
+    }
+    CustomerManager manager;
+    BulkLoadReport report = manager.loadBinary(binaryPath);
+    cout << "  loadBinary: " << report.rowsPerSecond() / 1e6 << " M rows/s" << endl;
+
+    remove(csvPath.c_str());
+    remove(binaryPath.c_str());
+}
+
+void benchmarkReportWriter() {
+    const size_t count = 1000000;
+    const string path = "customers_report_benchmark.txt";
+    CustomerManager manager;
+    manager.reserve(count);
+    for (auto& customer : makeBenchmarkCustomers(count)) {
+        manager.addCustomer(move(customer));
+    }
+    vector<const Customer*> sorted = manager.getCustomersSorted();
+
+    auto start = chrono::steady_clock::now();
+    {
+        ofstream out(path, ios::binary);
+        for (const Customer* customer : sorted) {
+            out << *customer << endl;
+        }
+    }
+    chrono::duration<double> endlTime = chrono::steady_clock::now() - start;
+
+    cout << "Report writer benchmark, " << count << " customers:\n"
+         << "  operator<< with endl: " << count / endlTime.count() / 1e6 << " M rows/s\n";
+    for (ReportFormat format : { ReportFormat::Text, ReportFormat::Csv }) {
+        start = chrono::steady_clock::now();
+        {
+            ofstream out(path, ios::binary);
+            CustomerReportWriter writer(out, format);
+            manager.writeCustomersSorted(writer);
+        }
+        chrono::duration<double> writerTime = chrono::steady_clock::now() - start;
+        cout << "  CustomerReportWriter, " << (format == ReportFormat::Csv ? "CSV" : "text") << ": "
+             << count / writerTime.count() / 1e6 << " M rows/s\n";
+    }
+    cout.flush();
+    remove(path.c_str());
+}
+
+void benchmarkParallelSort() {
+    const size_t count = 1000000;
+    vector<Customer> customers = makeBenchmarkCustomers(count);
+
+    auto start = chrono::steady_clock::now();
+    vector<Customer> copy = customers;
+    sort(copy.begin(), copy.end(), [](const Customer& a, const Customer& b) {
+        return a.getFullName() < b.getFullName();
+    });
+    chrono::duration<double> baselineTime = chrono::steady_clock::now() - start;
+    cout << "Parallel sort benchmark, " << count << " customers:\n"
+         << "  std::sort on getFullName(): " << baselineTime.count() * 1e3 << " ms\n";
+
+    unsigned maxThreads = max(1u, thread::hardware_concurrency());
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+        CustomerManager manager;
+        manager.reserve(count);
+        for (const auto& customer : customers) {
+            manager.addCustomer(customer);
+        }
+        start = chrono::steady_clock::now();
+        manager.sortByName(threads);
+        chrono::duration<double> sortTime = chrono::steady_clock::now() - start;
+        cout << "  sortByName, " << threads << " thread(s): " << sortTime.count() * 1e3 << " ms\n";
+
+        if (threads == 1) {
+            start = chrono::steady_clock::now();
+            size_t pageSize = manager.getCustomersPage(0, 100).size();
+            chrono::duration<double> pageTime = chrono::steady_clock::now() - start;
+            cout << "  first page of " << pageSize << ": " << pageTime.count() * 1e6 << " us\n";
+        }
+    }
+    cout.flush();
+}
+
+// Main function to run tests (pass --bench to also run the benchmarks)
+int main(int argc, char** argv) {
     testCustomerConstructorAndGetters();
     testDefaultConstructor();
     testOutputOperator();
@@ -170,7 +1790,33 @@ int main() {
     testEmptyFirstName();
     testEmptyCreditCardNumber();
     testAddCustomer();
+    testSortedIndex();
+    testCreditCardRangeIndex();
+    testManagerCopyKeepsIndexes();
+    testCustomerStoreRoundTrip();
+    testCustomerStoreInterning();
+    testCustomerStoreCreditCardRange();
+    testCustomerStoreCardTooLong();
+    testLoadCsv();
+    testLoadCsvParallel();
+    testLoadCsvMalformed();
+    testLoadMissingFile();
+    testBinaryRoundTrip();
+    testReportWriterText();
+    testReportWriterCsv();
+    testReportCsvRoundTrip();
+    testPrintCustomersByCreditCardRange();
+    testCustomersPage();
+    testSortByName();
+    testParallelSort();
 
     cout << "All tests passed!" << endl;
+
+    if (argc > 1 && string(argv[1]) == "--bench") {
+        benchmarkCustomerStore();
+        benchmarkBulkLoad();
+        benchmarkReportWriter();
+        benchmarkParallelSort();
+    }
     return 0;
 }
\ No newline at end of file
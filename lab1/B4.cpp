@@ -3,97 +3,1317 @@
 #include <cassert>
 #include <iomanip>
 #include <stdexcept>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include <complex>
+#include <cmath>
+#include <random>
+#include <thread>
+#include <queue>
+#include <functional>
+#include <climits>
+#include <array>
+#include <type_traits>
+#include <utility>
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// Set when the vector kernels round a * b + c once, so scalar tails can match them
+#if defined(__AVX512F__) || (defined(__AVX2__) && (defined(__FMA__) || defined(_MSC_VER)))
+#define POLYNOMIAL_FUSED_MULTIPLY_ADD
+#endif
 
 using namespace std;
 
-class Polynomial {
+// Unchecked coefficient loops shared by the Polynomial operators. Each kernel
+// uses AVX-512 or AVX2 when the compiler targets it and a scalar loop otherwise.
+class PolynomialKernels {
+private:
+#if defined(__AVX2__) && !defined(__AVX512F__)
+    static __m256d multiplyAdd(__m256d a, __m256d b, __m256d c) {
+#if defined(POLYNOMIAL_FUSED_MULTIPLY_ADD)
+        return _mm256_fmadd_pd(a, b, c);
+#else
+        return _mm256_add_pd(_mm256_mul_pd(a, b), c);
+#endif
+    }
+#endif
+
+    // a * b + c, rounded like the vector kernels
+    static double multiplyAdd(double a, double b, double c) {
+#if defined(POLYNOMIAL_FUSED_MULTIPLY_ADD)
+        return fma(a, b, c);
+#else
+        return a * b + c;
+#endif
+    }
+
+public:
+    // dst[i] += src[i]
+    static void add(double* dst, const double* src, size_t n) {
+        size_t i = 0;
+#if defined(__AVX512F__)
+        for (; i + 8 <= n; i += 8) {
+            _mm512_storeu_pd(dst + i, _mm512_add_pd(_mm512_loadu_pd(dst + i), _mm512_loadu_pd(src + i)));
+        }
+#elif defined(__AVX2__)
+        for (; i + 4 <= n; i += 4) {
+            _mm256_storeu_pd(dst + i, _mm256_add_pd(_mm256_loadu_pd(dst + i), _mm256_loadu_pd(src + i)));
+        }
+#endif
+        for (; i < n; ++i) {
+            dst[i] += src[i];
+        }
+    }
+
+    // dst[i] -= src[i]
+    static void subtract(double* dst, const double* src, size_t n) {
+        size_t i = 0;
+#if defined(__AVX512F__)
+        for (; i + 8 <= n; i += 8) {
+            _mm512_storeu_pd(dst + i, _mm512_sub_pd(_mm512_loadu_pd(dst + i), _mm512_loadu_pd(src + i)));
+        }
+#elif defined(__AVX2__)
+        for (; i + 4 <= n; i += 4) {
+            _mm256_storeu_pd(dst + i, _mm256_sub_pd(_mm256_loadu_pd(dst + i), _mm256_loadu_pd(src + i)));
+        }
+#endif
+        for (; i < n; ++i) {
+            dst[i] -= src[i];
+        }
+    }
+
+    // dst[i] += scale * src[i]
+    static void scaleAdd(double* dst, double scale, const double* src, size_t n) {
+        size_t i = 0;
+#if defined(__AVX512F__)
+        __m512d factor = _mm512_set1_pd(scale);
+        for (; i + 8 <= n; i += 8) {
+            _mm512_storeu_pd(dst + i, _mm512_fmadd_pd(factor, _mm512_loadu_pd(src + i), _mm512_loadu_pd(dst + i)));
+        }
+#elif defined(__AVX2__)
+        __m256d factor = _mm256_set1_pd(scale);
+        for (; i + 4 <= n; i += 4) {
+            _mm256_storeu_pd(dst + i, multiplyAdd(factor, _mm256_loadu_pd(src + i), _mm256_loadu_pd(dst + i)));
+        }
+#endif
+        for (; i < n; ++i) {
+            dst[i] = multiplyAdd(scale, src[i], dst[i]);
+        }
+    }
+
+    // out[j] = c[n - 1] * xs[j]^(n - 1) + ... + c[0] for count points, by Horner's
+    // rule run across points: independent points fill the vector lanes, and
+    // several vectors are interleaved so the multiply-add latency is hidden.
+    static void horner(const double* c, size_t n, const double* xs, double* out, size_t count) {
+        if (n == 0) {
+            fill(out, out + count, 0.0);
+            return;
+        }
+        size_t i = 0;
+#if defined(__AVX512F__)
+        for (; i + 32 <= count; i += 32) {
+            __m512d x0 = _mm512_loadu_pd(xs + i);
+            __m512d x1 = _mm512_loadu_pd(xs + i + 8);
+            __m512d x2 = _mm512_loadu_pd(xs + i + 16);
+            __m512d x3 = _mm512_loadu_pd(xs + i + 24);
+            __m512d a0 = _mm512_set1_pd(c[n - 1]);
+            __m512d a1 = a0;
+            __m512d a2 = a0;
+            __m512d a3 = a0;
+            for (size_t k = n - 1; k-- > 0;) {
+                __m512d coeff = _mm512_set1_pd(c[k]);
+                a0 = _mm512_fmadd_pd(a0, x0, coeff);
+                a1 = _mm512_fmadd_pd(a1, x1, coeff);
+                a2 = _mm512_fmadd_pd(a2, x2, coeff);
+                a3 = _mm512_fmadd_pd(a3, x3, coeff);
+            }
+            _mm512_storeu_pd(out + i, a0);
+            _mm512_storeu_pd(out + i + 8, a1);
+            _mm512_storeu_pd(out + i + 16, a2);
+            _mm512_storeu_pd(out + i + 24, a3);
+        }
+#elif defined(__AVX2__)
+        for (; i + 16 <= count; i += 16) {
+            __m256d x0 = _mm256_loadu_pd(xs + i);
+            __m256d x1 = _mm256_loadu_pd(xs + i + 4);
+            __m256d x2 = _mm256_loadu_pd(xs + i + 8);
+            __m256d x3 = _mm256_loadu_pd(xs + i + 12);
+            __m256d a0 = _mm256_set1_pd(c[n - 1]);
+            __m256d a1 = a0;
+            __m256d a2 = a0;
+            __m256d a3 = a0;
+            for (size_t k = n - 1; k-- > 0;) {
+                __m256d coeff = _mm256_set1_pd(c[k]);
+                a0 = multiplyAdd(a0, x0, coeff);
+                a1 = multiplyAdd(a1, x1, coeff);
+                a2 = multiplyAdd(a2, x2, coeff);
+                a3 = multiplyAdd(a3, x3, coeff);
+            }
+            _mm256_storeu_pd(out + i, a0);
+            _mm256_storeu_pd(out + i + 4, a1);
+            _mm256_storeu_pd(out + i + 8, a2);
+            _mm256_storeu_pd(out + i + 12, a3);
+        }
+#else
+        for (; i + 8 <= count; i += 8) {
+            double acc[8];
+            for (size_t j = 0; j < 8; ++j) {
+                acc[j] = c[n - 1];
+            }
+            for (size_t k = n - 1; k-- > 0;) {
+                for (size_t j = 0; j < 8; ++j) {
+                    acc[j] = acc[j] * xs[i + j] + c[k];
+                }
+            }
+            copy(acc, acc + 8, out + i);
+        }
+#endif
+        for (; i < count; ++i) {
+            double acc = c[n - 1];
+            for (size_t k = n - 1; k-- > 0;) {
+                acc = multiplyAdd(acc, xs[i], c[k]);
+            }
+            out[i] = acc;
+        }
+    }
+
+    // Shorter-operand length from which multiplyAdd switches from schoolbook
+    // to Karatsuba, and from Karatsuba to FFT. The defaults come from the
+    // crossovers found by benchmarkMultiplicationThresholds(); wider vector
+    // units keep schoolbook competitive for longer. newtonDivisionThreshold is
+    // the shorter of quotient and divisor length from which division switches
+    // from long division to the Newton reciprocal (see benchmarkDivision()).
+#if defined(__AVX512F__)
+    static inline size_t karatsubaThreshold = 192;
+    static inline size_t fftThreshold = 3072;
+    static inline size_t newtonDivisionThreshold = 3072;
+#elif defined(__AVX2__)
+    static inline size_t karatsubaThreshold = 160;
+    static inline size_t fftThreshold = 1536;
+    static inline size_t newtonDivisionThreshold = 1536;
+#else
+    static inline size_t karatsubaThreshold = 40;
+    static inline size_t fftThreshold = 512;
+    static inline size_t newtonDivisionThreshold = 384;
+#endif
+
+    // dst[0 .. n + m - 1) += a[0 .. n) * b[0 .. m), schoolbook convolution.
+    static void schoolbookMultiplyAdd(double* dst, const double* a, size_t n, const double* b, size_t m) {
+        for (size_t i = 0; i < n; ++i) {
+            if (a[i] != 0) {
+                scaleAdd(dst + i, a[i], b, m);
+            }
+        }
+    }
+
+    // Same contract as schoolbookMultiplyAdd, in O(n^1.59) for balanced operands.
+    // The longer operand is cut into blocks as long as the shorter one.
+    static void karatsubaMultiplyAdd(double* dst, const double* a, size_t n, const double* b, size_t m) {
+        if (n < m) {
+            swap(a, b);
+            swap(n, m);
+        }
+        if (m == 0) {
+            return;
+        }
+        vector<double> block(2 * m - 1);
+        vector<double> scratch(8 * m + 64);
+        for (size_t offset = 0; offset < n; offset += m) {
+            size_t length = min(m, n - offset);
+            if (length < m) {
+                multiplyAdd(dst + offset, b, m, a + offset, length);
+                break;
+            }
+            karatsuba(a + offset, b, m, block.data(), scratch.data());
+            add(dst + offset, block.data(), block.size());
+        }
+    }
+
+    // Same contract as schoolbookMultiplyAdd, via one complex FFT of size
+    // N >= n + m - 1 and its inverse, in O(N log N). Rounding error on each
+    // result coefficient stays within about eps * log2(N) * (|a|_2^2 + |b|_2^2)
+    // after b is rescaled by a power of two to the magnitude of a.
+    static void fftMultiplyAdd(double* dst, const double* a, size_t n, const double* b, size_t m) {
+        if (n == 0 || m == 0) {
+            return;
+        }
+        double maxA = 0;
+        double maxB = 0;
+        for (size_t i = 0; i < n; ++i) {
+            maxA = max(maxA, abs(a[i]));
+        }
+        for (size_t i = 0; i < m; ++i) {
+            maxB = max(maxB, abs(b[i]));
+        }
+        if (maxA == 0 || maxB == 0) {
+            return;
+        }
+        int exponentA;
+        int exponentB;
+        frexp(maxA, &exponentA);
+        frexp(maxB, &exponentB);
+        int shift = exponentA - exponentB;
+
+        // z = a + i * b * 2^shift; the imaginary part of z * z is 2 * a * b * 2^shift.
+        size_t size = 1;
+        while (size < n + m - 1) {
+            size *= 2;
+        }
+        vector<complex<double>> z(size);
+        for (size_t i = 0; i < n; ++i) {
+            z[i].real(a[i]);
+        }
+        for (size_t i = 0; i < m; ++i) {
+            z[i].imag(ldexp(b[i], shift));
+        }
+        vector<complex<double>> roots = fftRoots(size);
+        fft(z, roots, false);
+        for (auto& value : z) {
+            value = multiply(value, value);
+        }
+        fft(z, roots, true);
+        double scale = ldexp(0.5 / size, -shift);
+        for (size_t i = 0; i < n + m - 1; ++i) {
+            dst[i] += z[i].imag() * scale;
+        }
+    }
+
+    // dst[0 .. n + m - 1) += a[0 .. n) * b[0 .. m), choosing schoolbook,
+    // Karatsuba or FFT by the length of the shorter operand.
+    static void multiplyAdd(double* dst, const double* a, size_t n, const double* b, size_t m) {
+        size_t shorter = min(n, m);
+        if (shorter < karatsubaThreshold) {
+            schoolbookMultiplyAdd(dst, a, n, b, m);
+        } else if (shorter < fftThreshold) {
+            karatsubaMultiplyAdd(dst, a, n, b, m);
+        } else {
+            fftMultiplyAdd(dst, a, n, b, m);
+        }
+    }
+
+    // out[0 .. length) = (a[0 .. n) * b[0 .. m)) mod x^length
+    static void multiplyLow(double* out, const double* a, size_t n, const double* b, size_t m, size_t length) {
+        n = min(n, length);
+        m = min(m, length);
+        fill(out, out + length, 0.0);
+        if (n == 0 || m == 0) {
+            return;
+        }
+        vector<double> product(n + m - 1, 0.0);
+        multiplyAdd(product.data(), a, n, b, m);
+        copy(product.begin(), product.begin() + min(length, product.size()), out);
+    }
+
+    // First length coefficients of the power series 1 / f[0 .. n), f[0] != 0.
+    // Each Newton step g <- g - g * (f * g - 1) doubles the number of correct terms.
+    static vector<double> reciprocal(const double* f, size_t n, size_t length) {
+        vector<double> g(length, 0.0);
+        vector<double> error(length);
+        vector<double> correction(length);
+        g[0] = 1.0 / f[0];
+        for (size_t known = 1; known < length;) {
+            size_t next = min(2 * known, length);
+            multiplyLow(error.data(), f, n, g.data(), known, next);
+            // The first known terms of f * g - 1 vanish up to rounding.
+            fill(error.begin(), error.begin() + known, 0.0);
+            multiplyLow(correction.data(), g.data(), known, error.data(), next, next);
+            for (size_t i = known; i < next; ++i) {
+                g[i] = -correction[i];
+            }
+            known = next;
+        }
+        return g;
+    }
+
+    // Long division of a[0 .. n) by b[0 .. m), n >= m, b[m - 1] != 0. Writes the
+    // n - m + 1 quotient coefficients and leaves the remainder in a[0 .. m - 1),
+    // clearing a[m - 1 .. n). Each step is one vectorized scaleAdd.
+    static void longDivide(double* a, size_t n, const double* b, size_t m, double* quotient) {
+        double lead = b[m - 1];
+        for (size_t k = n - m + 1; k-- > 0;) {
+            double coeff = a[k + m - 1] / lead;
+            quotient[k] = coeff;
+            if (coeff != 0) {
+                scaleAdd(a + k, -coeff, b, m - 1);
+            }
+            a[k + m - 1] = 0;
+        }
+    }
+
+    // Same result as longDivide, with a[0 .. n) left unchanged and the m - 1
+    // remainder coefficients written to remainder. The reversed quotient is the
+    // reversed dividend times the reciprocal series of the reversed divisor.
+    static void newtonDivide(const double* a, size_t n, const double* b, size_t m, double* quotient, double* remainder) {
+        size_t quotientLength = n - m + 1;
+        vector<double> reversedA(quotientLength);
+        vector<double> reversedB(min(m, quotientLength));
+        for (size_t i = 0; i < reversedA.size(); ++i) {
+            reversedA[i] = a[n - 1 - i];
+        }
+        for (size_t i = 0; i < reversedB.size(); ++i) {
+            reversedB[i] = b[m - 1 - i];
+        }
+        vector<double> inverse = reciprocal(reversedB.data(), reversedB.size(), quotientLength);
+        vector<double> reversedQuotient(quotientLength);
+        multiplyLow(reversedQuotient.data(), reversedA.data(), quotientLength, inverse.data(), quotientLength,
+                    quotientLength);
+        for (size_t i = 0; i < quotientLength; ++i) {
+            quotient[i] = reversedQuotient[quotientLength - 1 - i];
+        }
+
+        // remainder = a - b * quotient, of which only the low m - 1 terms survive
+        multiplyLow(remainder, b, m, quotient, quotientLength, m - 1);
+        for (size_t i = 0; i + 1 < m; ++i) {
+            remainder[i] = a[i] - remainder[i];
+        }
+    }
+
+private:
+    // out[0 .. 2n - 1) = a[0 .. n) * b[0 .. n). Needs at most 8n + 64 scratch doubles.
+    static void karatsuba(const double* a, const double* b, size_t n, double* out, double* scratch) {
+        if (n < max<size_t>(karatsubaThreshold, 2)) {
+            fill(out, out + 2 * n - 1, 0.0);
+            schoolbookMultiplyAdd(out, a, n, b, n);
+            return;
+        }
+        size_t low = n / 2;
+        size_t high = n - low;
+
+        // out = low product, a gap of one zero, high product
+        karatsuba(a, b, low, out, scratch);
+        out[2 * low - 1] = 0;
+        karatsuba(a + low, b + low, high, out + 2 * low, scratch);
+
+        // middle = (a0 + a1)(b0 + b1) - low product - high product
+        double* sumA = scratch;
+        double* sumB = scratch + high;
+        double* middle = scratch + 2 * high;
+        copy(a + low, a + n, sumA);
+        copy(b + low, b + n, sumB);
+        add(sumA, a, low);
+        add(sumB, b, low);
+        karatsuba(sumA, sumB, high, middle, middle + 2 * high - 1);
+        subtract(middle, out, 2 * low - 1);
+        subtract(middle, out + 2 * low, 2 * high - 1);
+        add(out + low, middle, 2 * high - 1);
+    }
+
+    static complex<double> multiply(complex<double> x, complex<double> y) {
+        return complex<double>(x.real() * y.real() - x.imag() * y.imag(),
+                               x.real() * y.imag() + x.imag() * y.real());
+    }
+
+    // exp(-2 pi i k / size) for k < size / 2, each computed directly for accuracy.
+    static vector<complex<double>> fftRoots(size_t size) {
+        const double pi = acos(-1.0);
+        vector<complex<double>> roots(size / 2);
+        for (size_t k = 0; k < roots.size(); ++k) {
+            double angle = -2 * pi * static_cast<double>(k) / static_cast<double>(size);
+            roots[k] = complex<double>(cos(angle), sin(angle));
+        }
+        return roots;
+    }
+
+    // Iterative radix-2 FFT; the inverse is left unnormalized.
+    static void fft(vector<complex<double>>& data, const vector<complex<double>>& roots, bool inverse) {
+        size_t size = data.size();
+        for (size_t i = 1, j = 0; i < size; ++i) {
+            size_t bit = size >> 1;
+            for (; j & bit; bit >>= 1) {
+                j ^= bit;
+            }
+            j ^= bit;
+            if (i < j) {
+                swap(data[i], data[j]);
+            }
+        }
+        for (size_t length = 2; length <= size; length *= 2) {
+            size_t half = length / 2;
+            size_t step = size / length;
+            for (size_t start = 0; start < size; start += length) {
+                for (size_t k = 0; k < half; ++k) {
+                    complex<double> root = roots[k * step];
+                    if (inverse) {
+                        root = conj(root);
+                    }
+                    complex<double> u = data[start + k];
+                    complex<double> v = multiply(data[start + k + half], root);
+                    data[start + k] = u + v;
+                    data[start + k + half] = u - v;
+                }
+            }
+        }
+    }
+};
+
+struct PolynomialDivision;
+
+// Base of the lazy nodes that +, - and scalar * build on polynomials. A node
+// only refers to its named operands; converting it to a Polynomial evaluates
+// the whole chain in one pass into a single allocation. Nodes are meant to be
+// converted within the full expression that builds them: keeping one in an
+// auto variable is unsupported, since it dangles once an operand goes away.
+// They are [[nodiscard]] and cannot be copied to make such misuse harder.
+struct PolynomialExpression {};
+
+class Polynomial {
+private:
+    vector<double> coefficients; // Coefficients of the polynomial
+
+public:
+    // Constructor to initialize a polynomial of degree n
+    Polynomial(int degree) : coefficients(degree + 1, 0.0) {}
+
+    // Evaluates a chain such as p1 + p2 - 2.0 * p3. Up to the shortest operand
+    // the loop runs without bounds checks; the rest pads missing terms with 0.
+    template <typename Expression, typename = enable_if_t<is_base_of_v<PolynomialExpression, Expression>>>
+    Polynomial(const Expression& expression) : coefficients(expression.size()) {
+        double* data = coefficients.data();
+        size_t shared = expression.sharedSize();
+        for (size_t i = 0; i < shared; ++i) {
+            data[i] = expression.coefficientUnchecked(i);
+        }
+        for (size_t i = shared; i < coefficients.size(); ++i) {
+            data[i] = expression.coefficientOrZero(i);
+        }
+    }
+
+    // Set coefficient for a specific degree
+    void setCoefficient(int degree, double value) {
+        if (degree < 0 || degree >= coefficients.size()) {
+            throw out_of_range("Degree is out of range.");
+        }
+        coefficients[degree] = value;
+    }
+    
+    // Get coefficient for a specific degree
+    double getCoefficient(int pos) const {
+        return this->coefficients.at(pos);
+    }
+
+    // Returns the number of stored coefficients (degree + 1).
+    size_t size() const {
+        return coefficients.size();
+    }
+
+    // Returns all coefficients, lowest degree first
+    const vector<double>& getCoefficients() const {
+        return coefficients;
+    }
+
+    // Leaf interface of the expression nodes: every index below sharedSize()
+    // is stored, coefficientOrZero() also accepts the ones past the end
+    size_t sharedSize() const {
+        return coefficients.size();
+    }
+
+    double coefficientUnchecked(size_t i) const {
+        return coefficients[i];
+    }
+
+    double coefficientOrZero(size_t i) const {
+        return i < coefficients.size() ? coefficients[i] : 0.0;
+    }
+
+    // Value of the polynomial at x
+    double evaluate(double x) const {
+        double result;
+        PolynomialKernels::horner(coefficients.data(), coefficients.size(), &x, &result, 1);
+        return result;
+    }
+
+    // Values of the polynomial at xs[0 .. count), written to out[0 .. count).
+    // Large batches are split into contiguous slices, one per thread.
+    void evaluate(const double* xs, double* out, size_t count, unsigned threadCount = 1) const {
+        size_t slices = max<size_t>(1, min<size_t>(threadCount, count / 4096));
+        const double* c = coefficients.data();
+        size_t n = coefficients.size();
+        vector<thread> workers;
+        for (size_t slice = 1; slice < slices; ++slice) {
+            size_t first = count * slice / slices;
+            size_t last = count * (slice + 1) / slices;
+            workers.emplace_back([c, n, xs, out, first, last] {
+                PolynomialKernels::horner(c, n, xs + first, out + first, last - first);
+            });
+        }
+        PolynomialKernels::horner(c, n, xs, out, count / slices);
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    // Values of the polynomial at every point of xs
+    vector<double> evaluate(const vector<double>& xs, unsigned threadCount = 1) const {
+        vector<double> out(xs.size());
+        evaluate(xs.data(), out.data(), xs.size(), threadCount);
+        return out;
+    }
+
+    // In-place addition; grows to the larger degree if needed
+    Polynomial& operator+=(const Polynomial& other) {
+        if (other.coefficients.size() > coefficients.size()) {
+            coefficients.resize(other.coefficients.size(), 0.0);
+        }
+        PolynomialKernels::add(coefficients.data(), other.coefficients.data(), other.coefficients.size());
+        return *this;
+    }
+
+    // In-place subtraction; grows to the larger degree if needed
+    Polynomial& operator-=(const Polynomial& other) {
+        if (other.coefficients.size() > coefficients.size()) {
+            coefficients.resize(other.coefficients.size(), 0.0);
+        }
+        PolynomialKernels::subtract(coefficients.data(), other.coefficients.data(), other.coefficients.size());
+        return *this;
+    }
+
+    // In-place multiplication. Small products work from the highest coefficient
+    // down, so every coefficient is consumed before its slot receives products;
+    // larger ones go through the faster algorithms of operator*.
+    Polynomial& operator*=(const Polynomial& other) {
+        size_t n = coefficients.size();
+        size_t m = other.coefficients.size();
+        if (min(n, m) >= PolynomialKernels::karatsubaThreshold) {
+            return *this = *this * other;
+        }
+        if (&other == this) {
+            Polynomial copy = other;
+            return *this *= copy;
+        }
+        if (n == 0 || m == 0) {
+            coefficients.clear();
+            return *this;
+        }
+        coefficients.resize(n + m - 1, 0.0);
+        double* data = coefficients.data();
+        for (size_t i = n; i-- > 0;) {
+            double coeff = data[i];
+            data[i] = 0;
+            if (coeff != 0) {
+                PolynomialKernels::scaleAdd(data + i, coeff, other.coefficients.data(), m);
+            }
+        }
+        return *this;
+    }
+
+    // Fused multiply-add: adds a * b to this polynomial without a temporary
+    Polynomial& multiplyAdd(const Polynomial& a, const Polynomial& b) {
+        if (a.coefficients.empty() || b.coefficients.empty()) {
+            return *this;
+        }
+        if (&a == this || &b == this) {
+            Polynomial product = a * b;
+            return *this += product;
+        }
+        size_t productSize = a.coefficients.size() + b.coefficients.size() - 1;
+        if (productSize > coefficients.size()) {
+            coefficients.resize(productSize, 0.0);
+        }
+        PolynomialKernels::multiplyAdd(coefficients.data(), a.coefficients.data(), a.coefficients.size(),
+                                       b.coefficients.data(), b.coefficients.size());
+        return *this;
+    }
+
+    // Adds scale * other to this polynomial
+    Polynomial& multiplyAdd(double scale, const Polynomial& other) {
+        if (other.coefficients.size() > coefficients.size()) {
+            coefficients.resize(other.coefficients.size(), 0.0);
+        }
+        PolynomialKernels::scaleAdd(coefficients.data(), scale, other.coefficients.data(), other.coefficients.size());
+        return *this;
+    }
+
+    // Multiplication of two polynomials
+    Polynomial operator*(const Polynomial& other) const {
+        if (coefficients.empty() || other.coefficients.empty()) {
+            return Polynomial(-1);
+        }
+        Polynomial result(static_cast<int>(coefficients.size() + other.coefficients.size() - 2));
+        PolynomialKernels::multiplyAdd(result.coefficients.data(), coefficients.data(), coefficients.size(),
+                                       other.coefficients.data(), other.coefficients.size());
+        return result;
+    }
+
+    // Division with remainder: *this == divisor * quotient + remainder, with the
+    // remainder of lower degree than the divisor
+    PolynomialDivision divide(const Polynomial& divisor) const;
+
+    // Division of two polynomials, quotient only
+    Polynomial operator/(const Polynomial& other) const;
+
+    // Remainder of the division of two polynomials
+    Polynomial operator%(const Polynomial& other) const;
+
+    // Display the polynomial
+    void display() const {
+        for (int i = coefficients.size() - 1; i >= 0; --i) {
+            if (coefficients[i] != 0) {
+                if (i != coefficients.size() - 1) {
+                    cout << " + ";
+                }
+                cout << fixed << setprecision(2) << coefficients[i] << "x^" << i;
+            }
+        }
+        cout << endl;
+    }
+
+private:
+    // Number of coefficients up to the highest non-zero one
+    size_t significantSize() const {
+        size_t n = coefficients.size();
+        while (n > 0 && coefficients[n - 1] == 0) {
+            --n;
+        }
+        return n;
+    }
+};
+
+// Quotient and remainder of a polynomial division
+struct PolynomialDivision {
+    Polynomial quotient;
+    Polynomial remainder;
+};
+
+inline PolynomialDivision Polynomial::divide(const Polynomial& divisor) const {
+    size_t m = divisor.significantSize();
+    if (m == 0) {
+        throw domain_error("Division by zero polynomial.");
+    }
+    size_t n = significantSize();
+    if (n < m) {
+        return PolynomialDivision{ Polynomial(0), *this };
+    }
+
+    size_t quotientLength = n - m + 1;
+    PolynomialDivision result{ Polynomial(static_cast<int>(quotientLength) - 1), Polynomial(max<int>(static_cast<int>(m) - 2, 0)) };
+    if (min(quotientLength, m) >= PolynomialKernels::newtonDivisionThreshold) {
+        PolynomialKernels::newtonDivide(coefficients.data(), n, divisor.coefficients.data(), m,
+                                        result.quotient.coefficients.data(), result.remainder.coefficients.data());
+    } else {
+        vector<double> work(coefficients.begin(), coefficients.begin() + n);
+        PolynomialKernels::longDivide(work.data(), n, divisor.coefficients.data(), m,
+                                      result.quotient.coefficients.data());
+        copy(work.begin(), work.begin() + (m - 1), result.remainder.coefficients.begin());
+    }
+    return result;
+}
+
+inline Polynomial Polynomial::operator/(const Polynomial& other) const {
+    return divide(other).quotient;
+}
+
+inline Polynomial Polynomial::operator%(const Polynomial& other) const {
+    return divide(other).remainder;
+}
+
+// True for Polynomial and for the lazy nodes built from it
+template <typename T>
+constexpr bool isPolynomialExpression = is_same_v<decay_t<T>, Polynomial> || is_base_of_v<PolynomialExpression, decay_t<T>>;
+
+// How a node keeps an operand: named values by reference, temporaries (such as
+// the product in p1 + p3 * p4) moved into the node so they outlive the call
+template <typename T>
+using PolynomialOperand = conditional_t<is_lvalue_reference_v<T>, const decay_t<T>&, decay_t<T>>;
+
+// left + right, or left - right when Subtract is set
+template <typename Left, typename Right, bool Subtract>
+class [[nodiscard]] PolynomialSum : public PolynomialExpression {
+private:
+    Left left;
+    Right right;
+
+public:
+    template <typename L, typename R>
+    PolynomialSum(L&& left, R&& right) : left(forward<L>(left)), right(forward<R>(right)) {}
+
+    PolynomialSum(const PolynomialSum&) = delete;
+    PolynomialSum(PolynomialSum&&) = default;
+    PolynomialSum& operator=(const PolynomialSum&) = delete;
+
+    size_t size() const {
+        return max(left.size(), right.size());
+    }
+
+    size_t sharedSize() const {
+        return min(left.sharedSize(), right.sharedSize());
+    }
+
+    double coefficientUnchecked(size_t i) const {
+        if constexpr (Subtract) {
+            return left.coefficientUnchecked(i) - right.coefficientUnchecked(i);
+        } else {
+            return left.coefficientUnchecked(i) + right.coefficientUnchecked(i);
+        }
+    }
+
+    double coefficientOrZero(size_t i) const {
+        if constexpr (Subtract) {
+            return left.coefficientOrZero(i) - right.coefficientOrZero(i);
+        } else {
+            return left.coefficientOrZero(i) + right.coefficientOrZero(i);
+        }
+    }
+};
+
+// scale * operand
+template <typename Operand>
+class [[nodiscard]] PolynomialScaled : public PolynomialExpression {
+private:
+    double scale;
+    Operand operand;
+
+public:
+    template <typename T>
+    PolynomialScaled(double scale, T&& operand) : scale(scale), operand(forward<T>(operand)) {}
+
+    PolynomialScaled(const PolynomialScaled&) = delete;
+    PolynomialScaled(PolynomialScaled&&) = default;
+    PolynomialScaled& operator=(const PolynomialScaled&) = delete;
+
+    size_t size() const {
+        return operand.size();
+    }
+
+    size_t sharedSize() const {
+        return operand.sharedSize();
+    }
+
+    double coefficientUnchecked(size_t i) const {
+        return scale * operand.coefficientUnchecked(i);
+    }
+
+    double coefficientOrZero(size_t i) const {
+        return scale * operand.coefficientOrZero(i);
+    }
+};
+
+// Addition of two polynomials or expressions, evaluated when converted to a Polynomial
+template <typename L, typename R, typename = enable_if_t<isPolynomialExpression<L> && isPolynomialExpression<R>>>
+PolynomialSum<PolynomialOperand<L>, PolynomialOperand<R>, false> operator+(L&& left, R&& right) {
+    return { forward<L>(left), forward<R>(right) };
+}
+
+// Subtraction of two polynomials or expressions
+template <typename L, typename R, typename = enable_if_t<isPolynomialExpression<L> && isPolynomialExpression<R>>>
+PolynomialSum<PolynomialOperand<L>, PolynomialOperand<R>, true> operator-(L&& left, R&& right) {
+    return { forward<L>(left), forward<R>(right) };
+}
+
+// Multiplication by a scalar
+template <typename E, typename = enable_if_t<isPolynomialExpression<E>>>
+PolynomialScaled<PolynomialOperand<E>> operator*(double scale, E&& operand) {
+    return { scale, forward<E>(operand) };
+}
+
+template <typename E, typename = enable_if_t<isPolynomialExpression<E>>>
+PolynomialScaled<PolynomialOperand<E>> operator*(E&& operand, double scale) {
+    return { scale, forward<E>(operand) };
+}
+
+// Negation
+template <typename E, typename = enable_if_t<isPolynomialExpression<E>>>
+PolynomialScaled<PolynomialOperand<E>> operator-(E&& operand) {
+    return { -1.0, forward<E>(operand) };
+}
+
+// Products and divisions cannot be fused, so an expression operand is
+// evaluated first and a Polynomial operand is used as is
+inline const Polynomial& materialize(const Polynomial& p) {
+    return p;
+}
+
+template <typename E, typename = enable_if_t<is_base_of_v<PolynomialExpression, E>>>
+Polynomial materialize(const E& expression) {
+    return Polynomial(expression);
+}
+
+template <typename L, typename R>
+using EnableIfMixedPolynomialOperands = enable_if_t<isPolynomialExpression<L> && isPolynomialExpression<R> &&
+    !(is_same_v<decay_t<L>, Polynomial> && is_same_v<decay_t<R>, Polynomial>)>;
+
+template <typename L, typename R, typename = EnableIfMixedPolynomialOperands<L, R>>
+Polynomial operator*(const L& left, const R& right) {
+    return materialize(left) * materialize(right);
+}
+
+template <typename L, typename R, typename = EnableIfMixedPolynomialOperands<L, R>>
+Polynomial operator/(const L& left, const R& right) {
+    return materialize(left) / materialize(right);
+}
+
+template <typename L, typename R, typename = EnableIfMixedPolynomialOperands<L, R>>
+Polynomial operator%(const L& left, const R& right) {
+    return materialize(left) % materialize(right);
+}
+
+struct SparsePolynomialDivision;
+
+// Polynomial stored as its non-zero terms in increasing exponent order, so
+// x^1000000 + 1 takes two terms instead of a million coefficients. Offers the
+// Polynomial operators; sums merge term lists, products and quotients use
+// heaps, and operands full enough to be cheaper densely go through Polynomial.
+class SparsePolynomial {
+public:
+    struct Term {
+        int exponent;
+        double coefficient;
+    };
+
+    // Products with more term pairs than this many per result coefficient are computed densely
+    static inline double denseProductRatio = 8.0;
+    // Divisions where both operands are at least this full are computed densely
+    static inline double denseFillRatio = 0.25;
+
+private:
+    vector<Term> terms;
+
+    // Orders heap entries by exponent: streams of products b[i] * q[j]
+    struct HeapEntry {
+        long long exponent;
+        size_t i;
+        size_t j;
+
+        bool operator<(const HeapEntry& other) const {
+            return exponent < other.exponent;
+        }
+        bool operator>(const HeapEntry& other) const {
+            return exponent > other.exponent;
+        }
+    };
+
+    // a + sign * b by merging the two term lists
+    static vector<Term> merge(const vector<Term>& a, const vector<Term>& b, double sign) {
+        vector<Term> result;
+        result.reserve(a.size() + b.size());
+        size_t i = 0;
+        size_t j = 0;
+        while (i < a.size() || j < b.size()) {
+            if (j == b.size() || (i < a.size() && a[i].exponent < b[j].exponent)) {
+                result.push_back(a[i++]);
+            } else if (i == a.size() || b[j].exponent < a[i].exponent) {
+                result.push_back(Term{ b[j].exponent, sign * b[j].coefficient });
+                ++j;
+            } else {
+                double coefficient = a[i].coefficient + sign * b[j].coefficient;
+                if (coefficient != 0) {
+                    result.push_back(Term{ a[i].exponent, coefficient });
+                }
+                ++i;
+                ++j;
+            }
+        }
+        return result;
+    }
+
+    // Product by Johnson's algorithm: one stream a[i] * b[0 ..] per term of
+    // the shorter operand, merged through a min-heap in exponent order.
+    static vector<Term> multiplyTerms(const vector<Term>* a, const vector<Term>* b) {
+        vector<Term> result;
+        if (a->empty() || b->empty()) {
+            return result;
+        }
+        if (a->size() > b->size()) {
+            swap(a, b);
+        }
+        if (static_cast<long long>(a->back().exponent) + b->back().exponent > INT_MAX) {
+            throw overflow_error("Exponent is out of range.");
+        }
+        priority_queue<HeapEntry, vector<HeapEntry>, greater<HeapEntry>> heap;
+        for (size_t i = 0; i < a->size(); ++i) {
+            heap.push(HeapEntry{ static_cast<long long>((*a)[i].exponent) + (*b)[0].exponent, i, 0 });
+        }
+        while (!heap.empty()) {
+            long long exponent = heap.top().exponent;
+            double coefficient = 0;
+            while (!heap.empty() && heap.top().exponent == exponent) {
+                HeapEntry entry = heap.top();
+                heap.pop();
+                coefficient += (*a)[entry.i].coefficient * (*b)[entry.j].coefficient;
+                if (entry.j + 1 < b->size()) {
+                    heap.push(HeapEntry{ static_cast<long long>((*a)[entry.i].exponent) + (*b)[entry.j + 1].exponent,
+                                         entry.i, entry.j + 1 });
+                }
+            }
+            if (coefficient != 0) {
+                result.push_back(Term{ static_cast<int>(exponent), coefficient });
+            }
+        }
+        return result;
+    }
+
+    // x^n by repeated squaring
+    static double power(double x, int n) {
+        double result = 1;
+        for (; n > 0; n >>= 1, x *= x) {
+            if (n & 1) {
+                result *= x;
+            }
+        }
+        return result;
+    }
+
+public:
+    // Zero polynomial
+    SparsePolynomial() = default;
+
+    // Keeps the non-zero coefficients of a dense polynomial
+    explicit SparsePolynomial(const Polynomial& dense) {
+        const vector<double>& coefficients = dense.getCoefficients();
+        for (size_t i = 0; i < coefficients.size(); ++i) {
+            if (coefficients[i] != 0) {
+                terms.push_back(Term{ static_cast<int>(i), coefficients[i] });
+            }
+        }
+    }
+
+    // Set coefficient for a specific degree; zero removes the term
+    void setCoefficient(int degree, double value) {
+        if (degree < 0) {
+            throw out_of_range("Degree is out of range.");
+        }
+        auto it = lower_bound(terms.begin(), terms.end(), degree,
+                              [](const Term& term, int exponent) { return term.exponent < exponent; });
+        if (it != terms.end() && it->exponent == degree) {
+            if (value == 0) {
+                terms.erase(it);
+            } else {
+                it->coefficient = value;
+            }
+        } else if (value != 0) {
+            terms.insert(it, Term{ degree, value });
+        }
+    }
+
+    // Get coefficient for a specific degree, zero when there is no such term
+    double getCoefficient(int degree) const {
+        if (degree < 0) {
+            throw out_of_range("Degree is out of range.");
+        }
+        auto it = lower_bound(terms.begin(), terms.end(), degree,
+                              [](const Term& term, int exponent) { return term.exponent < exponent; });
+        return it != terms.end() && it->exponent == degree ? it->coefficient : 0;
+    }
+
+    // Returns the non-zero terms, lowest exponent first
+    const vector<Term>& getTerms() const {
+        return terms;
+    }
+
+    // Highest exponent with a non-zero coefficient, -1 for the zero polynomial
+    int degree() const {
+        return terms.empty() ? -1 : terms.back().exponent;
+    }
+
+    // Share of non-zero coefficients among degree() + 1
+    double fillRatio() const {
+        return terms.empty() ? 0 : static_cast<double>(terms.size()) / (terms.back().exponent + 1.0);
+    }
+
+    // Dense copy of degree max(degree(), 0)
+    Polynomial toDense() const {
+        Polynomial dense(max(degree(), 0));
+        for (const Term& term : terms) {
+            dense.setCoefficient(term.exponent, term.coefficient);
+        }
+        return dense;
+    }
+
+    // Value of the polynomial at x
+    double evaluate(double x) const {
+        double result = 0;
+        for (size_t k = terms.size(); k-- > 0;) {
+            int gap = terms[k].exponent - (k > 0 ? terms[k - 1].exponent : 0);
+            result = (result + terms[k].coefficient) * power(x, gap);
+        }
+        return result;
+    }
+
+    SparsePolynomial& operator+=(const SparsePolynomial& other) {
+        terms = merge(terms, other.terms, 1.0);
+        return *this;
+    }
+
+    SparsePolynomial& operator-=(const SparsePolynomial& other) {
+        terms = merge(terms, other.terms, -1.0);
+        return *this;
+    }
+
+    SparsePolynomial& operator*=(const SparsePolynomial& other) {
+        return *this = *this * other;
+    }
+
+    // Addition of two polynomials
+    SparsePolynomial operator+(const SparsePolynomial& other) const {
+        SparsePolynomial result;
+        result.terms = merge(terms, other.terms, 1.0);
+        return result;
+    }
+
+    // Subtraction of two polynomials
+    SparsePolynomial operator-(const SparsePolynomial& other) const {
+        SparsePolynomial result;
+        result.terms = merge(terms, other.terms, -1.0);
+        return result;
+    }
+
+    // Multiplication of two polynomials, dense when the term pairs outnumber
+    // the result coefficients by denseProductRatio
+    SparsePolynomial operator*(const SparsePolynomial& other) const {
+        if (terms.empty() || other.terms.empty()) {
+            return SparsePolynomial();
+        }
+        double pairs = static_cast<double>(terms.size()) * other.terms.size();
+        double resultLength = static_cast<double>(degree()) + other.degree() + 1;
+        if (pairs > denseProductRatio * resultLength) {
+            return SparsePolynomial(toDense() * other.toDense());
+        }
+        SparsePolynomial result;
+        result.terms = multiplyTerms(&terms, &other.terms);
+        return result;
+    }
+
+    // Division with remainder: *this == divisor * quotient + remainder
+    SparsePolynomialDivision divide(const SparsePolynomial& divisor) const;
+
+    // Division of two polynomials, quotient only
+    SparsePolynomial operator/(const SparsePolynomial& other) const;
+
+    // Remainder of the division of two polynomials
+    SparsePolynomial operator%(const SparsePolynomial& other) const;
+
+    // Display the polynomial
+    void display() const {
+        for (size_t k = terms.size(); k-- > 0;) {
+            if (k != terms.size() - 1) {
+                cout << " + ";
+            }
+            cout << fixed << setprecision(2) << terms[k].coefficient << "x^" << terms[k].exponent;
+        }
+        cout << endl;
+    }
+};
+
+// Quotient and remainder of a sparse polynomial division
+struct SparsePolynomialDivision {
+    SparsePolynomial quotient;
+    SparsePolynomial remainder;
+};
+
+// Sparse long division after Johnson: remainder terms are produced from the
+// highest exponent down, and the products divisor[i] * quotient[j] still to
+// subtract are merged through a max-heap with one stream per quotient term.
+inline SparsePolynomialDivision SparsePolynomial::divide(const SparsePolynomial& divisor) const {
+    if (divisor.terms.empty()) {
+        throw domain_error("Division by zero polynomial.");
+    }
+    if (fillRatio() >= denseFillRatio && divisor.fillRatio() >= denseFillRatio) {
+        PolynomialDivision dense = toDense().divide(divisor.toDense());
+        return SparsePolynomialDivision{ SparsePolynomial(dense.quotient), SparsePolynomial(dense.remainder) };
+    }
+
+    // Highest terms first
+    const vector<Term>& a = terms;
+    const vector<Term>& b = divisor.terms;
+    auto dividendTerm = [&](size_t k) -> const Term& { return a[a.size() - 1 - k]; };
+    auto divisorTerm = [&](size_t i) -> const Term& { return b[b.size() - 1 - i]; };
+    const Term& lead = divisorTerm(0);
+
+    SparsePolynomialDivision result;
+    vector<Term>& quotient = result.quotient.terms;
+    vector<Term>& remainder = result.remainder.terms;
+    priority_queue<HeapEntry> heap;
+    size_t k = 0;
+    while (k < a.size() || !heap.empty()) {
+        long long exponent = k < a.size() ? dividendTerm(k).exponent : LLONG_MIN;
+        if (!heap.empty()) {
+            exponent = max(exponent, heap.top().exponent);
+        }
+        double coefficient = 0;
+        if (k < a.size() && dividendTerm(k).exponent == exponent) {
+            coefficient = dividendTerm(k++).coefficient;
+        }
+        while (!heap.empty() && heap.top().exponent == exponent) {
+            HeapEntry entry = heap.top();
+            heap.pop();
+            coefficient -= divisorTerm(entry.i).coefficient * quotient[entry.j].coefficient;
+            if (entry.i + 1 < b.size()) {
+                heap.push(HeapEntry{ static_cast<long long>(divisorTerm(entry.i + 1).exponent) + quotient[entry.j].exponent,
+                                     entry.i + 1, entry.j });
+            }
+        }
+        if (coefficient == 0) {
+            continue;
+        }
+        if (exponent >= lead.exponent) {
+            quotient.push_back(Term{ static_cast<int>(exponent - lead.exponent), coefficient / lead.coefficient });
+            if (b.size() > 1) {
+                heap.push(HeapEntry{ static_cast<long long>(divisorTerm(1).exponent) + quotient.back().exponent, 1,
+                                     quotient.size() - 1 });
+            }
+        } else {
+            remainder.push_back(Term{ static_cast<int>(exponent), coefficient });
+        }
+    }
+    reverse(quotient.begin(), quotient.end());
+    reverse(remainder.begin(), remainder.end());
+    return result;
+}
+
+inline SparsePolynomial SparsePolynomial::operator/(const SparsePolynomial& other) const {
+    return divide(other).quotient;
+}
+
+inline SparsePolynomial SparsePolynomial::operator%(const SparsePolynomial& other) const {
+    return divide(other).remainder;
+}
+
+// Polynomial of degree at most N with coefficients in a std::array, for small
+// degrees known at compile time (splines, cost curves). Nothing allocates,
+// loops have a constant trip count the compiler unrolls, and all arithmetic
+// and evaluation is constexpr.
+template <size_t N, typename T = double>
+class FixedPolynomial {
 private:
-    vector<double> coefficients; // Coefficients of the polynomial
+    array<T, N + 1> coefficients{}; // Coefficients of the polynomial, lowest degree first
 
 public:
-    // Constructor to initialize a polynomial of degree n
-    Polynomial(int degree) : coefficients(degree + 1, 0.0) {}
+    // Zero polynomial
+    constexpr FixedPolynomial() = default;
+
+    // Polynomial with all N + 1 coefficients given, lowest degree first
+    template <typename... Values, typename = enable_if_t<sizeof...(Values) == N + 1>>
+    constexpr explicit FixedPolynomial(Values... values) : coefficients{ { static_cast<T>(values)... } } {}
+
+    // Copies a dense polynomial; throws when it has a non-zero term above x^N
+    static FixedPolynomial fromPolynomial(const Polynomial& dense) {
+        const vector<double>& source = dense.getCoefficients();
+        FixedPolynomial result;
+        for (size_t i = 0; i < source.size(); ++i) {
+            if (i <= N) {
+                result.coefficients[i] = static_cast<T>(source[i]);
+            } else if (source[i] != 0) {
+                throw out_of_range("Degree is out of range.");
+            }
+        }
+        return result;
+    }
+
+    // Dense copy of degree N
+    Polynomial toPolynomial() const {
+        Polynomial dense(static_cast<int>(N));
+        for (size_t i = 0; i <= N; ++i) {
+            dense.setCoefficient(static_cast<int>(i), static_cast<double>(coefficients[i]));
+        }
+        return dense;
+    }
+
+    // Degree of the storage, the same as Polynomial(N)
+    static constexpr size_t degree() {
+        return N;
+    }
 
     // Set coefficient for a specific degree
-    void setCoefficient(int degree, double value) {
-        if (degree < 0 || degree >= coefficients.size()) {
+    constexpr void setCoefficient(size_t degree, T value) {
+        if (degree > N) {
             throw out_of_range("Degree is out of range.");
         }
         coefficients[degree] = value;
     }
-    
+
     // Get coefficient for a specific degree
-    double getCoefficient(int pos) {
-        return this->coefficients.at(pos);
+    constexpr T getCoefficient(size_t degree) const {
+        if (degree > N) {
+            throw out_of_range("Degree is out of range.");
+        }
+        return coefficients[degree];
     }
 
-    // Addition of two polynomials
-    Polynomial operator+(const Polynomial& other) const {
-        int maxDegree = max(coefficients.size(), other.coefficients.size());
-        Polynomial result(maxDegree - 1);
-        for (int i = 0; i < maxDegree; ++i) {
-            double thisCoeff = (i < coefficients.size()) ? coefficients[i] : 0;
-            double otherCoeff = (i < other.coefficients.size()) ? other.coefficients[i] : 0;
-            result.setCoefficient(i, thisCoeff + otherCoeff);
+    // Value of the polynomial at x, by Horner's rule
+    constexpr T evaluate(T x) const {
+        T result = coefficients[N];
+        for (size_t k = N; k-- > 0;) {
+            result = result * x + coefficients[k];
         }
         return result;
     }
 
-    // Subtraction of two polynomials
-    Polynomial operator-(const Polynomial& other) const {
-        int maxDegree = max(coefficients.size(), other.coefficients.size());
-        Polynomial result(maxDegree - 1);
-        for (int i = 0; i < maxDegree; ++i) {
-            double thisCoeff = (i < coefficients.size()) ? coefficients[i] : 0;
-            double otherCoeff = (i < other.coefficients.size()) ? other.coefficients[i] : 0;
-            result.setCoefficient(i, thisCoeff - otherCoeff);
+    constexpr FixedPolynomial& operator+=(const FixedPolynomial& other) {
+        for (size_t i = 0; i <= N; ++i) {
+            coefficients[i] += other.coefficients[i];
         }
-        return result;
+        return *this;
     }
 
-    // Multiplication of two polynomials
-    Polynomial operator*(const Polynomial& other) const {
-        int resultDegree = coefficients.size() + other.coefficients.size() - 2;
-        Polynomial result(resultDegree);
-        for (int i = 0; i < coefficients.size(); ++i) {
-            for (int j = 0; j < other.coefficients.size(); ++j) {
-                result.setCoefficient(i + j, result.coefficients[i + j] + coefficients[i] * other.coefficients[j]);
-            }
+    constexpr FixedPolynomial& operator-=(const FixedPolynomial& other) {
+        for (size_t i = 0; i <= N; ++i) {
+            coefficients[i] -= other.coefficients[i];
         }
-        return result;
+        return *this;
     }
 
-    // Division of two polynomials (simple case, no remainder)
-    Polynomial operator/(const Polynomial& other) const {
-        if (other.coefficients.size() == 1 && other.coefficients[0] == 0) {
-            throw domain_error("Division by zero polynomial.");
+    constexpr FixedPolynomial& operator*=(T scale) {
+        for (size_t i = 0; i <= N; ++i) {
+            coefficients[i] *= scale;
         }
-        
-        int resultDegree = coefficients.size() - other.coefficients.size() + 1;
-        Polynomial result(resultDegree);
-        Polynomial remainder = *this;
+        return *this;
+    }
 
-        // Perform polynomial long division
-        for (int i = 0; i <= resultDegree; ++i) {
-            double coeff = remainder.coefficients[remainder.coefficients.size() - 1] / other.coefficients[other.coefficients.size() - 1];
-            result.setCoefficient(resultDegree - i, coeff);
-            Polynomial temp = other * Polynomial(resultDegree - i);
-            remainder = remainder - temp;
+    // Addition of two polynomials; the result has the larger degree
+    template <size_t M>
+    constexpr FixedPolynomial<(N > M ? N : M), T> operator+(const FixedPolynomial<M, T>& other) const {
+        FixedPolynomial<(N > M ? N : M), T> result;
+        for (size_t i = 0; i <= N; ++i) {
+            result.setCoefficient(i, coefficients[i]);
+        }
+        for (size_t i = 0; i <= M; ++i) {
+            result.setCoefficient(i, result.getCoefficient(i) + other.getCoefficient(i));
         }
         return result;
     }
 
-    // Display the polynomial
-    void display() const {
-        for (int i = coefficients.size() - 1; i >= 0; --i) {
-            if (coefficients[i] != 0) {
-                if (i != coefficients.size() - 1) {
-                    cout << " + ";
-                }
-                cout << fixed << setprecision(2) << coefficients[i] << "x^" << i;
+    // Subtraction of two polynomials; the result has the larger degree
+    template <size_t M>
+    constexpr FixedPolynomial<(N > M ? N : M), T> operator-(const FixedPolynomial<M, T>& other) const {
+        FixedPolynomial<(N > M ? N : M), T> result;
+        for (size_t i = 0; i <= N; ++i) {
+            result.setCoefficient(i, coefficients[i]);
+        }
+        for (size_t i = 0; i <= M; ++i) {
+            result.setCoefficient(i, result.getCoefficient(i) - other.getCoefficient(i));
+        }
+        return result;
+    }
+
+    // Multiplication of two polynomials; the degrees add up
+    template <size_t M>
+    constexpr FixedPolynomial<N + M, T> operator*(const FixedPolynomial<M, T>& other) const {
+        FixedPolynomial<N + M, T> result;
+        for (size_t i = 0; i <= N; ++i) {
+            for (size_t j = 0; j <= M; ++j) {
+                result.setCoefficient(i + j, result.getCoefficient(i + j) + coefficients[i] * other.getCoefficient(j));
             }
         }
-        cout << endl;
+        return result;
+    }
+
+    // Multiplication by a scalar
+    constexpr FixedPolynomial operator*(T scale) const {
+        FixedPolynomial result = *this;
+        result *= scale;
+        return result;
+    }
+
+    // First derivative, one degree lower (a constant stays a zero constant)
+    constexpr FixedPolynomial<(N > 0 ? N - 1 : 0), T> derivative() const {
+        FixedPolynomial<(N > 0 ? N - 1 : 0), T> result;
+        for (size_t i = 1; i <= N; ++i) {
+            result.setCoefficient(i - 1, coefficients[i] * static_cast<T>(i));
+        }
+        return result;
     }
 };
 
@@ -241,7 +1461,764 @@ void testSubtractionWithNullPolynomial() {
     assert(diff.getCoefficient(0) == 0);
 }
 
-int main() {
+// Test in-place addition and subtraction, including growth to a larger degree
+void testCompoundAddSubtract() {
+    Polynomial p1(1);
+    p1.setCoefficient(1, 3);
+    p1.setCoefficient(0, 1);
+
+    Polynomial p2(9);
+    for (int i = 0; i <= 9; ++i) {
+        p2.setCoefficient(i, i);
+    }
+
+    p1 += p2; // x^9 .. x^2 from p2, 4x + 1
+    assert(p1.size() == 10);
+    assert(p1.getCoefficient(9) == 9);
+    assert(p1.getCoefficient(1) == 4);
+    assert(p1.getCoefficient(0) == 1);
+
+    p1 -= p2;
+    assert(p1.getCoefficient(9) == 0);
+    assert(p1.getCoefficient(1) == 3);
+    assert(p1.getCoefficient(0) == 1);
+}
+
+// Test in-place multiplication, including multiplying a polynomial by itself
+void testCompoundMultiply() {
+    Polynomial p1(2);
+    p1.setCoefficient(2, 2);
+    p1.setCoefficient(1, 3);
+    p1.setCoefficient(0, 1);
+
+    Polynomial p2(1);
+    p2.setCoefficient(1, 2);
+    p2.setCoefficient(0, 2);
+
+    p1 *= p2; // Should be 4x^3 + 10x^2 + 8x + 2
+    assert(p1.size() == 4);
+    assert(p1.getCoefficient(3) == 4);
+    assert(p1.getCoefficient(2) == 10);
+    assert(p1.getCoefficient(1) == 8);
+    assert(p1.getCoefficient(0) == 2);
+
+    p2 *= p2; // Should be 4x^2 + 8x + 4
+    assert(p2.getCoefficient(2) == 4);
+    assert(p2.getCoefficient(1) == 8);
+    assert(p2.getCoefficient(0) == 4);
+}
+
+// Test fused multiply-add against separate multiplication and addition
+void testMultiplyAdd() {
+    Polynomial a(20);
+    Polynomial b(13);
+    Polynomial acc(5);
+    for (int i = 0; i <= 20; ++i) {
+        a.setCoefficient(i, i % 7 - 3);
+    }
+    for (int i = 0; i <= 13; ++i) {
+        b.setCoefficient(i, i % 5 + 1);
+    }
+    for (int i = 0; i <= 5; ++i) {
+        acc.setCoefficient(i, 10 * i);
+    }
+
+    Polynomial expected = acc + a * b;
+    acc.multiplyAdd(a, b);
+    assert(acc.size() == expected.size());
+    for (int i = 0; i < static_cast<int>(expected.size()); ++i) {
+        assert(acc.getCoefficient(i) == expected.getCoefficient(i));
+    }
+
+    acc.multiplyAdd(2.0, a);
+    assert(acc.getCoefficient(20) == expected.getCoefficient(20) + 2 * a.getCoefficient(20));
+}
+
+// Fills a polynomial with reproducible coefficients in [-1, 1]
+Polynomial makeRandomPolynomial(int degree, unsigned seed) {
+    mt19937 generator(seed);
+    uniform_real_distribution<double> distribution(-1.0, 1.0);
+    Polynomial p(degree);
+    for (int i = 0; i <= degree; ++i) {
+        p.setCoefficient(i, distribution(generator));
+    }
+    return p;
+}
+
+// Test Karatsuba against schoolbook on integer coefficients, where both are exact
+void testKaratsubaMultiplication() {
+    for (auto sizes : { make_pair(1, 1), make_pair(64, 64), make_pair(100, 37), make_pair(37, 300), make_pair(257, 256) }) {
+        vector<double> a(sizes.first);
+        vector<double> b(sizes.second);
+        for (size_t i = 0; i < a.size(); ++i) {
+            a[i] = static_cast<double>(i % 11) - 5;
+        }
+        for (size_t i = 0; i < b.size(); ++i) {
+            b[i] = static_cast<double>(i % 7) - 2;
+        }
+        vector<double> expected(a.size() + b.size() - 1, 1.0);
+        vector<double> actual(expected);
+        PolynomialKernels::schoolbookMultiplyAdd(expected.data(), a.data(), a.size(), b.data(), b.size());
+        PolynomialKernels::karatsubaMultiplyAdd(actual.data(), a.data(), a.size(), b.data(), b.size());
+        assert(actual == expected);
+    }
+}
+
+// Test FFT multiplication against schoolbook within the documented error bound
+void testFftMultiplication() {
+    for (auto sizes : { make_pair(1, 1), make_pair(3, 5), make_pair(1000, 999), make_pair(2048, 31) }) {
+        Polynomial a = makeRandomPolynomial(sizes.first - 1, 1);
+        Polynomial b = makeRandomPolynomial(sizes.second - 1, 2);
+        b.multiplyAdd(1e6 - 1, b); // Very different magnitudes
+        vector<double> x(a.size());
+        vector<double> y(b.size());
+        double normA = 0;
+        double normB = 0;
+        for (size_t i = 0; i < x.size(); ++i) {
+            x[i] = a.getCoefficient(static_cast<int>(i));
+            normA += x[i] * x[i];
+        }
+        for (size_t i = 0; i < y.size(); ++i) {
+            y[i] = b.getCoefficient(static_cast<int>(i));
+            normB += y[i] * y[i];
+        }
+
+        vector<double> expected(x.size() + y.size() - 1, 0.0);
+        vector<double> actual(expected);
+        PolynomialKernels::schoolbookMultiplyAdd(expected.data(), x.data(), x.size(), y.data(), y.size());
+        PolynomialKernels::fftMultiplyAdd(actual.data(), x.data(), x.size(), y.data(), y.size());
+
+        // Rescale b to the magnitude of a, as fftMultiplyAdd does, to evaluate the bound.
+        double scaleB = normA / normB;
+        double bound = 1e-15 * log2(2.0 * expected.size()) * (normA + normB * scaleB) / sqrt(scaleB);
+        for (size_t i = 0; i < expected.size(); ++i) {
+            assert(abs(actual[i] - expected[i]) <= bound);
+        }
+    }
+}
+
+// Test that operator* gives the same product on every algorithm
+void testAdaptiveMultiplication() {
+    Polynomial a = makeRandomPolynomial(1500, 3);
+    Polynomial b = makeRandomPolynomial(1200, 4);
+    Polynomial fast = a * b;
+
+    size_t karatsubaThreshold = PolynomialKernels::karatsubaThreshold;
+    size_t fftThreshold = PolynomialKernels::fftThreshold;
+    PolynomialKernels::karatsubaThreshold = SIZE_MAX;
+    PolynomialKernels::fftThreshold = SIZE_MAX;
+    Polynomial slow = a * b;
+    PolynomialKernels::karatsubaThreshold = karatsubaThreshold;
+    PolynomialKernels::fftThreshold = fftThreshold;
+
+    Polynomial inPlace = a;
+    inPlace *= b;
+    assert(fast.size() == slow.size());
+    assert(inPlace.size() == slow.size());
+    for (int i = 0; i < static_cast<int>(slow.size()); ++i) {
+        assert(abs(fast.getCoefficient(i) - slow.getCoefficient(i)) < 1e-9);
+        assert(abs(inPlace.getCoefficient(i) - slow.getCoefficient(i)) < 1e-9);
+    }
+}
+
+// Test division with remainder: (x^3 - 2x^2 - 4) / (x - 3) = x^2 + x + 3, remainder 5
+void testDivisionWithRemainder() {
+    Polynomial dividend(3);
+    dividend.setCoefficient(3, 1);
+    dividend.setCoefficient(2, -2);
+    dividend.setCoefficient(0, -4);
+
+    Polynomial divisor(3); // Unused high coefficients must not matter
+    divisor.setCoefficient(1, 1);
+    divisor.setCoefficient(0, -3);
+
+    PolynomialDivision result = dividend.divide(divisor);
+    assert(result.quotient.size() == 3);
+    assert(result.quotient.getCoefficient(2) == 1);
+    assert(result.quotient.getCoefficient(1) == 1);
+    assert(result.quotient.getCoefficient(0) == 3);
+    assert(result.remainder.size() == 1);
+    assert(result.remainder.getCoefficient(0) == 5);
+
+    assert((dividend / divisor).getCoefficient(0) == 3);
+    assert((dividend % divisor).getCoefficient(0) == 5);
+}
+
+// Test division by a polynomial of higher degree
+void testDivisionByHigherDegree() {
+    Polynomial dividend(1);
+    dividend.setCoefficient(1, 2);
+    dividend.setCoefficient(0, 1);
+    Polynomial divisor(2);
+    divisor.setCoefficient(2, 1);
+
+    PolynomialDivision result = dividend.divide(divisor);
+    assert(result.quotient.size() == 1);
+    assert(result.quotient.getCoefficient(0) == 0);
+    assert(result.remainder.getCoefficient(1) == 2);
+    assert(result.remainder.getCoefficient(0) == 1);
+}
+
+// Test that Newton division agrees with long division on a large input
+void testNewtonDivision() {
+    // A leading coefficient above the sum of the others keeps the divisor's
+    // roots inside the unit circle, so the quotient stays well-conditioned.
+    Polynomial divisor = makeRandomPolynomial(3000, 5);
+    double sum = 0;
+    for (int i = 0; i < 3000; ++i) {
+        sum += abs(divisor.getCoefficient(i));
+    }
+    divisor.setCoefficient(3000, sum + 1);
+    Polynomial quotient = makeRandomPolynomial(4000, 6);
+    Polynomial remainder = makeRandomPolynomial(2999, 7);
+    Polynomial dividend = divisor * quotient + remainder;
+
+    size_t threshold = PolynomialKernels::newtonDivisionThreshold;
+    PolynomialKernels::newtonDivisionThreshold = SIZE_MAX;
+    PolynomialDivision slow = dividend.divide(divisor);
+    PolynomialKernels::newtonDivisionThreshold = 1;
+    PolynomialDivision fast = dividend.divide(divisor);
+    PolynomialKernels::newtonDivisionThreshold = threshold;
+
+    assert(fast.quotient.size() == quotient.size());
+    assert(fast.remainder.size() == remainder.size());
+    for (int i = 0; i <= 4000; ++i) {
+        assert(abs(slow.quotient.getCoefficient(i) - quotient.getCoefficient(i)) < 1e-9);
+        assert(abs(fast.quotient.getCoefficient(i) - quotient.getCoefficient(i)) < 1e-9);
+    }
+    for (int i = 0; i < 3000; ++i) {
+        assert(abs(slow.remainder.getCoefficient(i) - remainder.getCoefficient(i)) < 1e-6);
+        assert(abs(fast.remainder.getCoefficient(i) - remainder.getCoefficient(i)) < 1e-6);
+    }
+}
+
+// Test evaluation at one point and at a batch of points on every code path
+void testEvaluate() {
+    Polynomial p(3); // 2x^3 - x + 5
+    p.setCoefficient(3, 2);
+    p.setCoefficient(1, -1);
+    p.setCoefficient(0, 5);
+    assert(p.evaluate(0.0) == 5);
+    assert(p.evaluate(2.0) == 19);
+    assert(p.evaluate(-1.0) == 4);
+    assert(Polynomial(-1).evaluate(3.0) == 0);
+
+    // 37 points cover the vector blocks and the scalar tail
+    vector<double> xs(37);
+    for (size_t i = 0; i < xs.size(); ++i) {
+        xs[i] = static_cast<double>(i) - 18;
+    }
+    vector<double> values = p.evaluate(xs);
+    for (size_t i = 0; i < xs.size(); ++i) {
+        double x = xs[i];
+        assert(values[i] == 2 * x * x * x - x + 5);
+    }
+}
+
+// Test that the multithreaded batch matches the single-threaded one
+void testEvaluateParallel() {
+    Polynomial p = makeRandomPolynomial(40, 8);
+    vector<double> xs(100003);
+    for (size_t i = 0; i < xs.size(); ++i) {
+        xs[i] = -1.0 + 2.0 * i / xs.size();
+    }
+    vector<double> expected = p.evaluate(xs);
+    for (unsigned threads : { 2u, 3u, 8u }) {
+        assert(p.evaluate(xs, threads) == expected);
+    }
+}
+
+// Test sparse coefficients, conversion and fill ratio
+void testSparseCoefficients() {
+    SparsePolynomial p;
+    p.setCoefficient(1000000, 1);
+    p.setCoefficient(0, 1);
+    assert(p.getTerms().size() == 2);
+    assert(p.degree() == 1000000);
+    assert(p.getCoefficient(1000000) == 1);
+    assert(p.getCoefficient(5) == 0);
+    assert(p.fillRatio() < 1e-5);
+    assert(p.evaluate(1.0) == 2);
+
+    p.setCoefficient(1000000, 0); // Removes the term
+    assert(p.degree() == 0);
+
+    Polynomial dense(3);
+    dense.setCoefficient(3, 2);
+    dense.setCoefficient(1, -1);
+    SparsePolynomial sparse(dense);
+    assert(sparse.getTerms().size() == 2);
+    assert(sparse.evaluate(2.0) == dense.evaluate(2.0));
+    Polynomial back = sparse.toDense();
+    assert(back.getCoefficients() == dense.getCoefficients());
+
+    try {
+        sparse.setCoefficient(-1, 5); // Negative degree
+        assert(false); // Should not reach here
+    } catch (const out_of_range& e) {
+        assert(true); // Expected exception
+    }
+}
+
+// Test sparse addition and subtraction, including cancelling terms
+void testSparseAddSubtract() {
+    SparsePolynomial a;
+    a.setCoefficient(500000, 3);
+    a.setCoefficient(2, 1);
+    SparsePolynomial b;
+    b.setCoefficient(500000, -3);
+    b.setCoefficient(7, 4);
+
+    SparsePolynomial sum = a + b; // 4x^7 + x^2
+    assert(sum.getTerms().size() == 2);
+    assert(sum.getCoefficient(7) == 4);
+    assert(sum.getCoefficient(2) == 1);
+
+    SparsePolynomial diff = a - b; // 6x^500000 - 4x^7 + x^2
+    assert(diff.getCoefficient(500000) == 6);
+    assert(diff.getCoefficient(7) == -4);
+
+    diff -= diff;
+    assert(diff.getTerms().empty());
+}
+
+// Test sparse multiplication by the heap and by the dense fallback
+void testSparseMultiply() {
+    SparsePolynomial p;
+    p.setCoefficient(1000000, 1);
+    p.setCoefficient(0, 1);
+    SparsePolynomial square = p * p; // x^2000000 + 2x^1000000 + 1
+    assert(square.getTerms().size() == 3);
+    assert(square.getCoefficient(2000000) == 1);
+    assert(square.getCoefficient(1000000) == 2);
+    assert(square.getCoefficient(0) == 1);
+
+    Polynomial a = makeRandomPolynomial(30, 9);
+    Polynomial b = makeRandomPolynomial(20, 10);
+    SparsePolynomial sparseA(a);
+    SparsePolynomial sparseB(b);
+    Polynomial expected = a * b;
+    double ratio = SparsePolynomial::denseProductRatio;
+    for (double forcedRatio : { 1e9, 0.0 }) { // Heap, then dense
+        SparsePolynomial::denseProductRatio = forcedRatio;
+        SparsePolynomial product = sparseA * sparseB;
+        for (int i = 0; i <= 50; ++i) {
+            assert(abs(product.getCoefficient(i) - expected.getCoefficient(i)) < 1e-12);
+        }
+    }
+    SparsePolynomial::denseProductRatio = ratio;
+}
+
+// Test sparse division: (x^10000 - 1) / (x^100 - 1) = x^9900 + x^9800 + ... + 1
+void testSparseDivide() {
+    SparsePolynomial dividend;
+    dividend.setCoefficient(10000, 1);
+    dividend.setCoefficient(0, -1);
+    SparsePolynomial divisor;
+    divisor.setCoefficient(100, 1);
+    divisor.setCoefficient(0, -1);
+
+    SparsePolynomialDivision result = dividend.divide(divisor);
+    assert(result.quotient.getTerms().size() == 100);
+    for (int e = 0; e <= 9900; e += 100) {
+        assert(result.quotient.getCoefficient(e) == 1);
+    }
+    assert(result.remainder.getTerms().empty());
+
+    dividend.setCoefficient(3, 5); // Now leaves 5x^3
+    assert((dividend % divisor).getCoefficient(3) == 5);
+    assert((dividend / divisor).getTerms().size() == 100);
+
+    try {
+        dividend / SparsePolynomial();
+        assert(false); // Should not reach here
+    } catch (const domain_error& e) {
+        assert(true); // Expected exception
+    }
+}
+
+// Test that sparse and dense division agree on dense inputs
+void testSparseDivideMatchesDense() {
+    Polynomial a = makeRandomPolynomial(40, 11);
+    Polynomial b = makeRandomPolynomial(9, 12);
+    b.setCoefficient(9, 10); // Dominant leading coefficient keeps the quotient well-conditioned
+    PolynomialDivision expected = a.divide(b);
+    double ratio = SparsePolynomial::denseFillRatio;
+    for (double forcedRatio : { 2.0, 0.0 }) { // Heap, then dense
+        SparsePolynomial::denseFillRatio = forcedRatio;
+        SparsePolynomialDivision actual = SparsePolynomial(a).divide(SparsePolynomial(b));
+        for (int i = 0; i <= 31; ++i) {
+            assert(abs(actual.quotient.getCoefficient(i) - expected.quotient.getCoefficient(i)) < 1e-9);
+        }
+        for (int i = 0; i < 9; ++i) {
+            assert(abs(actual.remainder.getCoefficient(i) - expected.remainder.getCoefficient(i)) < 1e-9);
+        }
+    }
+    SparsePolynomial::denseFillRatio = ratio;
+}
+
+// Test compile-time arithmetic and evaluation of fixed-degree polynomials
+void testFixedPolynomialConstexpr() {
+    constexpr FixedPolynomial<2> quadratic(1, 3, 2); // 2x^2 + 3x + 1
+    constexpr FixedPolynomial<1> linear(2, 2);       // 2x + 2
+    constexpr FixedPolynomial<3> product = quadratic * linear;
+    static_assert(product.getCoefficient(3) == 4, "4x^3");
+    static_assert(product.getCoefficient(2) == 10, "10x^2");
+    static_assert(product.getCoefficient(1) == 8, "8x");
+    static_assert(product.getCoefficient(0) == 2, "2");
+    static_assert(quadratic.evaluate(2) == 15, "2 * 4 + 3 * 2 + 1");
+    static_assert((quadratic + linear).getCoefficient(1) == 5, "3x + 2x");
+    static_assert((quadratic - linear).getCoefficient(0) == -1, "1 - 2");
+    static_assert(quadratic.derivative().evaluate(1) == 7, "4x + 3");
+    static_assert((quadratic * 2.0).getCoefficient(2) == 4, "2 * 2x^2");
+
+    constexpr FixedPolynomial<2, int> integer(1, 1, 1);
+    static_assert(integer.evaluate(3) == 13, "9 + 3 + 1");
+
+    FixedPolynomial<2> runtime = quadratic;
+    runtime += FixedPolynomial<2>(1, 1, 1);
+    runtime -= quadratic;
+    runtime *= 3.0;
+    assert(runtime.evaluate(2) == 21);
+
+    try {
+        runtime.setCoefficient(3, 1); // Out of range
+        assert(false); // Should not reach here
+    } catch (const out_of_range& e) {
+        assert(true); // Expected exception
+    }
+}
+
+// Test conversion between fixed-degree and dynamic polynomials
+void testFixedPolynomialConversion() {
+    FixedPolynomial<3> cubic(5, -1, 0, 2);
+    Polynomial dense = cubic.toPolynomial();
+    assert(dense.size() == 4);
+    assert(dense.evaluate(2.0) == cubic.evaluate(2.0));
+
+    Polynomial padded(6); // Zero terms above x^3 are accepted
+    padded.setCoefficient(2, 7);
+    FixedPolynomial<3> fromDense = FixedPolynomial<3>::fromPolynomial(padded);
+    assert(fromDense.getCoefficient(2) == 7);
+
+    padded.setCoefficient(5, 1);
+    try {
+        FixedPolynomial<3>::fromPolynomial(padded);
+        assert(false); // Should not reach here
+    } catch (const out_of_range& e) {
+        assert(true); // Expected exception
+    }
+}
+
+// Test that +, - and scalar * chains fuse into one allocation with the expected terms
+void testExpressionChain() {
+    Polynomial a(3), b(1), c(2), d(0);
+    for (int i = 0; i <= 3; ++i) {
+        a.setCoefficient(i, i + 1); // 4x^3 + 3x^2 + 2x + 1
+    }
+    b.setCoefficient(1, 5);
+    b.setCoefficient(0, -1); // 5x - 1
+    c.setCoefficient(2, 2); // 2x^2
+    d.setCoefficient(0, 3); // 3
+
+    // Nodes over named polynomials hold references and scale factors only, so
+    // the result is the one allocation
+    static_assert(sizeof(decltype(a + b)) == 2 * sizeof(const Polynomial*), "Sum must not copy its operands");
+    static_assert(sizeof(decltype(2.0 * c)) == sizeof(const Polynomial*) + sizeof(double), "Scaled must not copy its operand");
+    Polynomial chain = a + b - 2.0 * c + d * 0.5 - -a; // 8x^3 + 2x^2 + 9x + 2.5
+    assert(chain.getCoefficients().capacity() == chain.size());
+    assert(chain.size() == 4);
+    assert(chain.getCoefficient(3) == 8);
+    assert(chain.getCoefficient(2) == 2);
+    assert(chain.getCoefficient(1) == 9);
+    assert(chain.getCoefficient(0) == 2.5);
+
+    // A temporary operand is kept alive by the node that holds it until the
+    // full expression is converted
+    Polynomial fromTemporary = c * d + b;
+    assert(fromTemporary.getCoefficient(2) == 6);
+    assert(fromTemporary.getCoefficient(1) == 5);
+
+    // Products and divisions of expressions materialize their operands first
+    Polynomial product = (a + b) * (c - d);
+    Polynomial expected = Polynomial(a + b) * Polynomial(c - d);
+    assert(product.getCoefficients() == expected.getCoefficients());
+    Polynomial quotient = (product + d) / (c - d);
+    assert(quotient.getCoefficient(3) == 4);
+
+    a = a + a; // Aliased operands are read before the result replaces them
+    assert(a.getCoefficient(3) == 8);
+}
+
+// Benchmarks
+
+// Builds a polynomial of the given degree with non-trivial coefficients.
+Polynomial makeBenchmarkPolynomial(int degree) {
+    Polynomial p(degree);
+    for (int i = 0; i <= degree; ++i) {
+        p.setCoefficient(i, 1.0 + (i % 17) * 0.25);
+    }
+    return p;
+}
+
+// Repeats op in growing batches until at least minimumSeconds have passed and
+// returns the seconds one call takes
+template <typename Op>
+double measureSeconds(Op op, double minimumSeconds = 0.1) {
+    size_t calls = 0;
+    auto start = chrono::steady_clock::now();
+    chrono::duration<double> elapsed{ 0 };
+    for (size_t batch = 1; elapsed.count() < minimumSeconds; batch *= 2) {
+        for (size_t i = 0; i < batch; ++i) {
+            op();
+        }
+        calls += batch;
+        elapsed = chrono::steady_clock::now() - start;
+    }
+    return elapsed.count() / calls;
+}
+
+// GFLOP/s of op, timed over at least 0.2 s
+template <typename Op>
+double measureGflops(double flopsPerCall, Op op) {
+    return flopsPerCall / measureSeconds(op, 0.2) / 1e9;
+}
+
+void benchmarkPolynomialKernels() {
+    cout << "Polynomial kernel benchmark (GFLOP/s):\n";
+    for (int degree : { 15, 255, 4095, 65535 }) {
+        Polynomial a = makeBenchmarkPolynomial(degree);
+        Polynomial b = makeBenchmarkPolynomial(degree);
+        Polynomial acc = makeBenchmarkPolynomial(degree);
+        double n = degree + 1.0;
+
+        double add = measureGflops(n, [&] { acc += a; });
+        double sub = measureGflops(n, [&] { acc -= a; });
+        double plus = measureGflops(n, [&] { Polynomial sum = a + b; });
+        cout << "  degree " << degree << ": += " << add << ", -= " << sub << ", + " << plus;
+        if (degree <= 4095) {
+            double mul = measureGflops(2 * n * n, [&] { Polynomial product = a * b; });
+            double fma = measureGflops(2 * n * n, [&] { acc.multiplyAdd(a, b); });
+            double mulAssign = measureGflops(2 * n * n, [&] {
+                Polynomial product = a;
+                product *= b;
+            });
+            cout << ", * " << mul << ", *= " << mulAssign << ", multiplyAdd " << fma;
+        }
+        cout << "\n";
+    }
+    cout.flush();
+}
+
+// Tunes the multiplication thresholds on balanced operands. karatsubaThreshold
+// is the first length at which one Karatsuba split over schoolbook halves beats
+// plain schoolbook; fftThreshold is the first length at which FFT beats
+// Karatsuba recursing down to that threshold. The tuned values are applied
+// for the rest of the run and reported next to the compiled-in defaults.
+void benchmarkMultiplicationThresholds() {
+    const size_t defaultKaratsuba = PolynomialKernels::karatsubaThreshold;
+    const size_t defaultFft = PolynomialKernels::fftThreshold;
+    vector<size_t> lengths;
+    for (size_t length = 16; length <= 16384; length = length * 3 / 2) {
+        lengths.push_back(length);
+    }
+    auto makeOperand = [](size_t length) {
+        vector<double> x(length);
+        for (size_t i = 0; i < length; ++i) {
+            x[i] = 1.0 + (i % 17) * 0.25;
+        }
+        return x;
+    };
+
+    cout << "Polynomial multiplication benchmark (microseconds per product):\n";
+    size_t karatsubaFrom = 0;
+    for (size_t length : lengths) {
+        vector<double> x = makeOperand(length);
+        vector<double> out(2 * length - 1);
+        double schoolbook = measureSeconds([&] {
+            PolynomialKernels::schoolbookMultiplyAdd(out.data(), x.data(), length, x.data(), length);
+        });
+        PolynomialKernels::karatsubaThreshold = length;
+        double oneSplit = measureSeconds([&] {
+            PolynomialKernels::karatsubaMultiplyAdd(out.data(), x.data(), length, x.data(), length);
+        });
+        cout << "  length " << length << ": schoolbook " << schoolbook * 1e6 << ", one Karatsuba split "
+             << oneSplit * 1e6 << "\n";
+        if (oneSplit < schoolbook) {
+            karatsubaFrom = length;
+            break;
+        }
+    }
+    PolynomialKernels::karatsubaThreshold = karatsubaFrom != 0 ? karatsubaFrom : defaultKaratsuba;
+
+    size_t fftFrom = 0;
+    for (size_t length : lengths) {
+        if (length < PolynomialKernels::karatsubaThreshold) {
+            continue;
+        }
+        vector<double> x = makeOperand(length);
+        vector<double> out(2 * length - 1);
+        double karatsuba = measureSeconds([&] {
+            PolynomialKernels::karatsubaMultiplyAdd(out.data(), x.data(), length, x.data(), length);
+        });
+        double fft = measureSeconds([&] {
+            PolynomialKernels::fftMultiplyAdd(out.data(), x.data(), length, x.data(), length);
+        });
+        cout << "  length " << length << ": Karatsuba " << karatsuba * 1e6 << ", FFT " << fft * 1e6 << "\n";
+        if (fft < karatsuba) {
+            fftFrom = length;
+            break;
+        }
+    }
+    PolynomialKernels::fftThreshold = fftFrom != 0 ? fftFrom : defaultFft;
+
+    cout << "  tuned karatsubaThreshold " << PolynomialKernels::karatsubaThreshold << " (default "
+         << defaultKaratsuba << "), fftThreshold " << PolynomialKernels::fftThreshold << " (default "
+         << defaultFft << ")" << endl;
+}
+
+// Times long division against Newton division of a degree 2n polynomial by a degree n one
+void benchmarkDivision() {
+    cout << "Polynomial division benchmark (milliseconds):\n";
+    size_t threshold = PolynomialKernels::newtonDivisionThreshold;
+    for (int degree : { 250, 500, 1000, 2000, 4000, 16000, 50000 }) {
+        Polynomial divisor = makeBenchmarkPolynomial(degree);
+        divisor.setCoefficient(degree, 20.0 * degree);
+        Polynomial dividend = divisor * makeBenchmarkPolynomial(degree);
+
+        PolynomialKernels::newtonDivisionThreshold = SIZE_MAX;
+        double longDivision = measureSeconds([&] { dividend.divide(divisor); });
+        PolynomialKernels::newtonDivisionThreshold = 1;
+        double newton = measureSeconds([&] { dividend.divide(divisor); });
+        cout << "  degree " << 2 * degree << " / " << degree << ": long division " << longDivision * 1e3
+             << ", Newton " << newton * 1e3 << "\n";
+    }
+    PolynomialKernels::newtonDivisionThreshold = threshold;
+    cout.flush();
+}
+
+// Reports batch evaluation throughput in points per second for several degrees
+void benchmarkEvaluation() {
+    const size_t count = 1 << 20;
+    vector<double> xs(count);
+    for (size_t i = 0; i < count; ++i) {
+        xs[i] = -1.0 + 2.0 * i / count;
+    }
+    vector<double> out(count);
+    unsigned maxThreads = max(1u, thread::hardware_concurrency());
+    cout << "Polynomial evaluation benchmark (M points/s):\n";
+    for (int degree : { 3, 15, 63, 255 }) {
+        Polynomial p = makeBenchmarkPolynomial(degree);
+        double byCoefficient = measureSeconds([&] {
+            for (size_t i = 0; i < count; ++i) {
+                double acc = 0;
+                for (int k = degree; k >= 0; --k) {
+                    acc = acc * xs[i] + p.getCoefficient(k);
+                }
+                out[i] = acc;
+            }
+        });
+        cout << "  degree " << degree << ": getCoefficient loop " << count / byCoefficient / 1e6;
+        for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+            double batch = measureSeconds([&] { p.evaluate(xs.data(), out.data(), count, threads); });
+            cout << ", evaluate x" << threads << " " << count / batch / 1e6;
+        }
+        cout << "\n";
+    }
+    cout.flush();
+}
+
+// Builds a cubic as quadratic * linear and evaluates it, once per point, with
+// FixedPolynomial and with Polynomial, which allocates for every product
+void benchmarkFixedPolynomial() {
+    const size_t count = 1 << 20;
+    FixedPolynomial<2> fixedQuadratic(1.0, -0.5, 0.25);
+    Polynomial dynamicQuadratic = fixedQuadratic.toPolynomial();
+    vector<double> xs(count);
+    for (size_t i = 0; i < count; ++i) {
+        xs[i] = -1.0 + 2.0 * i / count;
+    }
+    double sink = 0;
+    double fixedTime = measureSeconds([&] {
+        for (double x : xs) {
+            FixedPolynomial<1> linear(x, 2.0);
+            sink += (fixedQuadratic * linear).evaluate(x);
+        }
+    });
+    double dynamicTime = measureSeconds([&] {
+        for (double x : xs) {
+            Polynomial linear(1);
+            linear.setCoefficient(0, x);
+            linear.setCoefficient(1, 2.0);
+            sink += (dynamicQuadratic * linear).evaluate(x);
+        }
+    });
+    cout << "Fixed-degree product and evaluation benchmark (M points/s): FixedPolynomial "
+         << count / fixedTime / 1e6 << ", Polynomial " << count / dynamicTime / 1e6 << (sink == 0 ? " " : "") << endl;
+}
+
+// Sum of terms[0 .. Count) written as one fused expression. When buffers is
+// given, it is increased by the coefficient arrays the sum creates: the nodes
+// hold none, so only the result's counts.
+template <size_t... I>
+Polynomial fusedSum(const vector<Polynomial>& terms, index_sequence<I...>, size_t* buffers = nullptr) {
+    Polynomial result = (... + terms[I]);
+    if (buffers != nullptr) {
+        *buffers += !result.getCoefficients().empty();
+    }
+    return result;
+}
+
+// The same sum with every step materialized, as before expression templates.
+// Each step's array is allocated while the previous one is still held, so a
+// new data() pointer marks every array created.
+Polynomial eagerSum(const vector<Polynomial>& terms, size_t count, size_t* buffers = nullptr) {
+    Polynomial result = Polynomial(terms[0] + terms[1]);
+    size_t created = 1;
+    for (size_t k = 2; k < count; ++k) {
+        const double* previous = result.getCoefficients().data();
+        result = Polynomial(result + terms[k]);
+        created += result.getCoefficients().data() != previous;
+    }
+    if (buffers != nullptr) {
+        *buffers += created;
+    }
+    return result;
+}
+
+template <size_t Count>
+void benchmarkExpressionChain(const vector<Polynomial>& terms) {
+    size_t fusedBuffers = 0, eagerBuffers = 0;
+    Polynomial fused = fusedSum(terms, make_index_sequence<Count>{}, &fusedBuffers);
+    Polynomial eager = eagerSum(terms, Count, &eagerBuffers);
+    assert(fused.getCoefficients() == eager.getCoefficients());
+    assert(fusedBuffers < eagerBuffers || Count == 2);
+
+    double fusedTime = measureSeconds([&] { Polynomial sum = fusedSum(terms, make_index_sequence<Count>{}); });
+    double eagerTime = measureSeconds([&] { Polynomial sum = eagerSum(terms, Count); });
+    cout << "  " << Count << " operands: fused " << fusedTime * 1e6 << " us / " << fusedBuffers
+         << " allocations, per step " << eagerTime * 1e6 << " us / " << eagerBuffers << " allocations\n";
+}
+
+template <size_t... Counts>
+void benchmarkExpressionChains(const vector<Polynomial>& terms, index_sequence<Counts...>) {
+    (benchmarkExpressionChain<Counts + 2>(terms), ...);
+}
+
+// Sums of 2 to 10 polynomials, fused into one pass versus one temporary per +
+void benchmarkExpressionTemplates() {
+    const int degree = 65535;
+    vector<Polynomial> terms;
+    for (int k = 0; k < 10; ++k) {
+        terms.push_back(makeBenchmarkPolynomial(degree - k));
+    }
+    cout << "Expression chain benchmark (degree " << degree << "):\n";
+    benchmarkExpressionChains(terms, make_index_sequence<9>{});
+    cout.flush();
+}
+
+// Main function to run tests (pass --bench to also run the benchmarks)
+int main(int argc, char** argv) {
     testSetCoefficient();
     testAddition();
     testSubtraction();
@@ -254,7 +2231,35 @@ int main() {
     testNegativeDegree();
     testAdditionWithNullPolynomial();
     testSubtractionWithNullPolynomial();
-    
+    testCompoundAddSubtract();
+    testCompoundMultiply();
+    testMultiplyAdd();
+    testKaratsubaMultiplication();
+    testFftMultiplication();
+    testAdaptiveMultiplication();
+    testDivisionWithRemainder();
+    testDivisionByHigherDegree();
+    testNewtonDivision();
+    testEvaluate();
+    testEvaluateParallel();
+    testSparseCoefficients();
+    testSparseAddSubtract();
+    testSparseMultiply();
+    testSparseDivide();
+    testSparseDivideMatchesDense();
+    testFixedPolynomialConstexpr();
+    testFixedPolynomialConversion();
+    testExpressionChain();
+
     cout << "All tests passed!" << endl;
+
+    if (argc > 1 && string(argv[1]) == "--bench") {
+        benchmarkPolynomialKernels();
+        benchmarkMultiplicationThresholds();
+        benchmarkDivision();
+        benchmarkEvaluation();
+        benchmarkFixedPolynomial();
+        benchmarkExpressionTemplates();
+    }
     return 0;
 }
\ No newline at end of file
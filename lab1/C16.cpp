@@ -3,10 +3,447 @@
 #include <cassert>
 #include <algorithm>
 #include <vector>
+#include <array>
+#include <cstdint>
+#include <climits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <type_traits>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#if defined(__BMI2__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
 
 using namespace std;
 
-class CharSet {
+#if defined(__AVX2__)
+// PSHUFB indices that move the bytes selected by an 8-bit mask to the front
+constexpr array<uint64_t, 256> makeCompactIndices() {
+    array<uint64_t, 256> table{};
+    for (int mask = 0; mask < 256; ++mask) {
+        int packed = 0;
+        for (int bit = 0; bit < 8; ++bit) {
+            if (mask & (1 << bit)) {
+                table[mask] |= static_cast<uint64_t>(bit) << (8 * packed++);
+            }
+        }
+    }
+    return table;
+}
+
+constexpr array<uint64_t, 256> compactIndices = makeCompactIndices();
+#endif
+
+// Bit tricks on 64-bit bitmap words shared by the dense sets
+struct BitWords {
+    static int popcount(uint64_t word) {
+#if defined(_MSC_VER)
+        return static_cast<int>(__popcnt64(word));
+#else
+        return __builtin_popcountll(word);
+#endif
+    }
+
+    static int countTrailingZeros(uint64_t word) {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward64(&index, word);
+        return static_cast<int>(index);
+#else
+        return __builtin_ctzll(word);
+#endif
+    }
+
+    // Position of the set bit with the given index (0 = lowest) in a word
+    // holding more than index set bits
+    static int selectInWord(uint64_t word, size_t index) {
+#if defined(__BMI2__)
+        return countTrailingZeros(_pdep_u64(uint64_t(1) << index, word));
+#else
+        // Byte-wise prefix popcounts locate the byte holding the bit; at most
+        // seven bits are then cleared inside it
+        const uint64_t ones = 0x0101010101010101;
+        uint64_t counts = word - ((word >> 1) & 0x5555555555555555);
+        counts = (counts & 0x3333333333333333) + ((counts >> 2) & 0x3333333333333333);
+        counts = (counts + (counts >> 4)) & 0x0F0F0F0F0F0F0F0F;
+        uint64_t prefix = counts * ones; // Byte b counts the bits in bytes 0..b
+        uint64_t below = ((index * ones | 0x8080808080808080) - prefix) & 0x8080808080808080;
+        int byte = popcount(below);
+        if (byte > 0) {
+            index -= (prefix >> (byte * 8 - 8)) & 0xFF;
+        }
+        unsigned bits = static_cast<unsigned>(word >> (byte * 8)) & 0xFF;
+        for (; index > 0; --index) {
+            bits &= bits - 1;
+        }
+        return byte * 8 + countTrailingZeros(bits);
+#endif
+    }
+};
+
+// The values First..Last of an integral or enum type, numbered from 0, as
+// the universe of a DenseSet
+template <typename T, T First, T Last>
+struct ValueRange {
+    using value_type = T;
+    static constexpr long long first = static_cast<long long>(First);
+    static constexpr long long last = static_cast<long long>(Last);
+    static_assert(first <= last, "Value range must not be empty.");
+    static constexpr size_t size = static_cast<size_t>(last - first) + 1;
+
+    static constexpr bool contains(T value) {
+        return first <= static_cast<long long>(value) && static_cast<long long>(value) <= last;
+    }
+
+    static constexpr size_t index(T value) {
+        return static_cast<size_t>(static_cast<long long>(value) - first);
+    }
+
+    static constexpr T value(size_t index) {
+        return static_cast<T>(first + static_cast<long long>(index));
+    }
+};
+
+// Set over a small universe stored as a bitmap with one bit per value, in
+// universe order. Membership is a single bit test, set algebra is one word
+// operation per 64 values and size() is a popcount. Universes of up to InlineBits values keep the bitmap inside the
+// object; larger ones (0..4095, a Unicode plane) keep it on the heap, so
+// copies and operator results allocate once.
+template <typename Universe>
+class DenseSet {
+public:
+    using value_type = typename Universe::value_type;
+    static constexpr size_t InlineBits = 1024;
+    static constexpr bool isInline = Universe::size <= InlineBits;
+
+protected:
+    static constexpr size_t WordCount = (Universe::size + 63) / 64;
+    using Words = conditional_t<isInline, array<uint64_t, WordCount>, vector<uint64_t>>;
+    Words words = emptyWords(); // Bit Universe::index(v) is set when v is present
+
+private:
+    static Words emptyWords() {
+        if constexpr (isInline) {
+            return Words{};
+        } else {
+            return Words(WordCount, 0);
+        }
+    }
+
+    static size_t checkedIndex(value_type element) {
+        if (!Universe::contains(element)) {
+            throw out_of_range("Element is outside the universe.");
+        }
+        return Universe::index(element);
+    }
+
+    // Word-by-word combination of two bitmaps
+    template <typename Op>
+    DenseSet combine(const DenseSet& other, Op op) const {
+        DenseSet result;
+        for (size_t w = 0; w < WordCount; ++w) {
+            result.words[w] = op(words[w], other.words[w]);
+        }
+        return result;
+    }
+
+public:
+    // Add an element to the set; throws out_of_range outside the universe
+    void add(value_type element) {
+        size_t bit = checkedIndex(element);
+        words[bit / 64] |= uint64_t(1) << (bit % 64);
+    }
+
+    // Remove an element from the set
+    void remove(value_type element) {
+        if (Universe::contains(element)) {
+            size_t bit = Universe::index(element);
+            words[bit / 64] &= ~(uint64_t(1) << (bit % 64));
+        }
+    }
+
+    // Check membership of an element in the set
+    bool contains(value_type element) const {
+        if (!Universe::contains(element)) {
+            return false;
+        }
+        size_t bit = Universe::index(element);
+        return (words[bit / 64] >> (bit % 64)) & 1;
+    }
+
+    // Number of elements in the set
+    size_t size() const {
+        size_t count = 0;
+        for (size_t w = 0; w < WordCount; ++w) {
+            count += BitWords::popcount(words[w]);
+        }
+        return count;
+    }
+
+    // Check whether the set has no elements
+    bool empty() const {
+        for (size_t w = 0; w < WordCount; ++w) {
+            if (words[w] != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Return the union of this set and another set
+    DenseSet unionWith(const DenseSet& other) const {
+        return combine(other, [](uint64_t a, uint64_t b) { return a | b; });
+    }
+
+    // Return the intersection of this set and another set
+    DenseSet intersectionWith(const DenseSet& other) const {
+        return combine(other, [](uint64_t a, uint64_t b) { return a & b; });
+    }
+
+    // Return the difference of this set and another set
+    DenseSet differenceWith(const DenseSet& other) const {
+        return combine(other, [](uint64_t a, uint64_t b) { return a & ~b; });
+    }
+
+    // Return the elements that are in exactly one of the two sets
+    DenseSet symmetricDifferenceWith(const DenseSet& other) const {
+        return combine(other, [](uint64_t a, uint64_t b) { return a ^ b; });
+    }
+
+    // Overloading + operator for union
+    DenseSet operator+(const DenseSet& other) const {
+        return unionWith(other);
+    }
+
+    // Overloading - operator for difference
+    DenseSet operator-(const DenseSet& other) const {
+        return differenceWith(other);
+    }
+
+    // Overloading * operator for intersection
+    DenseSet operator*(const DenseSet& other) const {
+        return intersectionWith(other);
+    }
+
+    // Number of elements smaller than element; throws out_of_range outside the universe
+    size_t rank(value_type element) const {
+        size_t bit = checkedIndex(element);
+        size_t count = 0;
+        for (size_t w = 0; w < bit / 64; ++w) {
+            count += BitWords::popcount(words[w]);
+        }
+        return count + BitWords::popcount(words[bit / 64] & ((uint64_t(1) << (bit % 64)) - 1));
+    }
+
+    // The element with the given index in universe order (0 = smallest)
+    value_type select(size_t index) const {
+        for (size_t w = 0; w < WordCount; ++w) {
+            size_t count = BitWords::popcount(words[w]);
+            if (index < count) {
+                return Universe::value(w * 64 + BitWords::selectInWord(words[w], index));
+            }
+            index -= count;
+        }
+        throw out_of_range("Index out of range.");
+    }
+
+    // Overloading [] operator for indexing elements in universe order
+    value_type operator[](size_t index) const {
+        return select(index);
+    }
+
+    // Display the contents of the set; enum values are shown as numbers
+    void display() const {
+        cout << "{ ";
+        for (size_t w = 0; w < WordCount; ++w) {
+            for (uint64_t word = words[w]; word != 0; word &= word - 1) {
+                value_type element = Universe::value(w * 64 + BitWords::countTrailingZeros(word));
+                if constexpr (is_enum_v<value_type>) {
+                    cout << static_cast<long long>(element) << " ";
+                } else {
+                    cout << element << " ";
+                }
+            }
+        }
+        cout << "}" << endl;
+    }
+
+    // Create a set with elements that are in only one of the two sets
+    static DenseSet exclusiveElements(const DenseSet& set1, const DenseSet& set2) {
+        return set1.symmetricDifferenceWith(set2);
+    }
+};
+
+using CharUniverse = ValueRange<char, CHAR_MIN, CHAR_MAX>;
+
+// Set of characters: a DenseSet over every char value, whose 256-bit bitmap
+// also drives the bulk scans of text below
+class CharSet : public DenseSet<CharUniverse> {
+    friend class SetManager;
+
+private:
+#if defined(__AVX2__)
+    // The bitmap as a 16x16 grid for PSHUFB: row (byte & 15) of lowHalf holds
+    // bytes 0x00-0x7F, one bit per high nibble, and highHalf bytes 0x80-0xFF.
+    // Both 16-byte tables are repeated in the two 128-bit lanes.
+    struct NibbleTables {
+        __m256i lowHalf;
+        __m256i highHalf;
+        __m256i bitOfHighNibble;
+    };
+
+    NibbleTables nibbleTables() const {
+        alignas(32) uint8_t low[32] = {};
+        alignas(32) uint8_t high[32] = {};
+        for (int byte = 0; byte < 256; ++byte) {
+            if (contains(static_cast<char>(byte))) {
+                uint8_t* rows = byte < 128 ? low : high;
+                rows[byte & 15] |= static_cast<uint8_t>(1 << ((byte >> 4) & 7));
+            }
+        }
+        copy(low, low + 16, low + 16);
+        copy(high, high + 16, high + 16);
+        return { _mm256_load_si256(reinterpret_cast<const __m256i*>(low)),
+                 _mm256_load_si256(reinterpret_cast<const __m256i*>(high)),
+                 _mm256_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128,
+                                  1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128) };
+    }
+
+    // Membership of the 32 bytes at text, bit k for text[k]. PSHUFB zeroes
+    // lanes whose index has bit 7 set, so each half only answers for its bytes.
+    static uint32_t matchMask(const NibbleTables& tables, const char* text) {
+        __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text));
+        __m256i highNibbles = _mm256_and_si256(_mm256_srli_epi16(bytes, 4), _mm256_set1_epi8(0x0F));
+        __m256i rows = _mm256_or_si256(_mm256_shuffle_epi8(tables.lowHalf, bytes),
+                                       _mm256_shuffle_epi8(tables.highHalf, _mm256_xor_si256(bytes, _mm256_set1_epi8(-128))));
+        __m256i bits = _mm256_shuffle_epi8(tables.bitOfHighNibble, highNibbles);
+        return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_and_si256(rows, bits), bits)));
+    }
+#endif
+
+    // Copies the bytes of a 32-byte block selected by mask to out and returns
+    // the end of the copy. With AVX2 each 8-byte group is packed by one PSHUFB
+    // and stored whole; the next group overwrites the unused tail.
+    static char* compactBlock(const char* block, uint32_t mask, char* out) {
+#if defined(__AVX2__)
+        for (int group = 0; group < 4; ++group, mask >>= 8, block += 8) {
+            __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(block));
+            __m128i indices = _mm_cvtsi64_si128(static_cast<long long>(compactIndices[mask & 0xFF]));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(out), _mm_shuffle_epi8(bytes, indices));
+            out += BitWords::popcount(mask & 0xFF);
+        }
+#else
+        for (; mask != 0; mask &= mask - 1) {
+            *out++ = block[BitWords::countTrailingZeros(mask)];
+        }
+#endif
+        return out;
+    }
+
+    // Calls block(offset, mask) for each 32-byte block of text, bit k of mask
+    // telling whether text[offset + k] is in the set, and byte(offset, member)
+    // for the remaining bytes (all of them without AVX2). Returning false from
+    // either callback ends the scan.
+    template <typename Block, typename Byte>
+    void scan(string_view text, [[maybe_unused]] Block block, Byte byte) const {
+        size_t i = 0;
+#if defined(__AVX2__)
+        if (text.size() >= 32) {
+            NibbleTables tables = nibbleTables();
+            for (; i + 32 <= text.size(); i += 32) {
+                if (!block(i, matchMask(tables, text.data() + i))) {
+                    return;
+                }
+            }
+        }
+#endif
+        for (; i < text.size(); ++i) {
+            if (!byte(i, contains(text[i]))) {
+                return;
+            }
+        }
+    }
+
+public:
+    CharSet() = default;
+
+    CharSet(const DenseSet<CharUniverse>& set) : DenseSet(set) {}
+
+    // Number of characters of text that are in the set
+    size_t countIn(string_view text) const {
+        size_t count = 0;
+        scan(text,
+             [&](size_t, uint32_t mask) { count += BitWords::popcount(mask); return true; },
+             [&](size_t, bool member) { count += member; return true; });
+        return count;
+    }
+
+    // Position of the first character of text that is in the set, or npos
+    size_t findFirstOf(string_view text) const {
+        size_t position = string_view::npos;
+        scan(text,
+             [&](size_t offset, uint32_t mask) {
+                 if (mask != 0) {
+                     position = offset + BitWords::countTrailingZeros(mask);
+                 }
+                 return mask == 0;
+             },
+             [&](size_t offset, bool member) {
+                 if (member) {
+                     position = offset;
+                 }
+                 return !member;
+             });
+        return position;
+    }
+
+    // Length of the longest prefix of text made only of characters in the set
+    size_t spanOf(string_view text) const {
+        size_t length = text.size();
+        scan(text,
+             [&](size_t offset, uint32_t mask) {
+                 if (mask != UINT32_MAX) {
+                     length = offset + BitWords::countTrailingZeros(~mask);
+                 }
+                 return mask == UINT32_MAX;
+             },
+             [&](size_t offset, bool member) {
+                 if (!member) {
+                     length = offset;
+                 }
+                 return member;
+             });
+        return length;
+    }
+
+    // Append the characters of text that are in the set to out, in order
+    void filterInto(string_view text, string& out) const {
+        size_t start = out.size();
+        out.resize(start + text.size());
+        char* next = &out[0] + start;
+        scan(text,
+             [&](size_t offset, uint32_t mask) {
+                 next = compactBlock(text.data() + offset, mask, next);
+                 return true;
+             },
+             [&](size_t offset, bool member) {
+                 *next = text[offset];
+                 next += member;
+                 return true;
+             });
+        out.resize(next - out.data());
+    }
+};
+
+// The original tree-based set, kept as the baseline of the CharSet benchmark
+class TreeCharSet {
 private:
     set<char> elements; // Set of characters
 
@@ -27,16 +464,16 @@ public:
     }
 
     // Return the union of this set and another set
-    CharSet unionWith(const CharSet& other) const {
-        CharSet result;
+    TreeCharSet unionWith(const TreeCharSet& other) const {
+        TreeCharSet result;
         result.elements.insert(elements.begin(), elements.end());
         result.elements.insert(other.elements.begin(), other.elements.end());
         return result;
     }
 
     // Return the intersection of this set and another set
-    CharSet intersectionWith(const CharSet& other) const {
-        CharSet result;
+    TreeCharSet intersectionWith(const TreeCharSet& other) const {
+        TreeCharSet result;
         for (char element : elements) {
             if (other.contains(element)) {
                 result.add(element);
@@ -46,8 +483,8 @@ public:
     }
 
     // Return the difference of this set and another set
-    CharSet differenceWith(const CharSet& other) const {
-        CharSet result;
+    TreeCharSet differenceWith(const TreeCharSet& other) const {
+        TreeCharSet result;
         for (char element : elements) {
             if (!other.contains(element)) {
                 result.add(element);
@@ -57,17 +494,17 @@ public:
     }
 
     // Overloading + operator for union
-    CharSet operator+(const CharSet& other) const {
+    TreeCharSet operator+(const TreeCharSet& other) const {
         return unionWith(other);
     }
 
     // Overloading - operator for difference
-    CharSet operator-(const CharSet& other) const {
+    TreeCharSet operator-(const TreeCharSet& other) const {
         return differenceWith(other);
     }
 
     // Overloading * operator for intersection
-    CharSet operator*(const CharSet& other) const {
+    TreeCharSet operator*(const TreeCharSet& other) const {
         return intersectionWith(other);
     }
 
@@ -82,7 +519,7 @@ public:
     }
 
     // Overloading = operator for assignment
-    CharSet& operator=(const CharSet& other) {
+    TreeCharSet& operator=(const TreeCharSet& other) {
         if (this != &other) {
             elements = other.elements;
         }
@@ -99,8 +536,8 @@ public:
     }
 
     // Create a set with elements that are in only one of the two sets
-    static CharSet exclusiveElements(const CharSet& set1, const CharSet& set2) {
-        CharSet result;
+    static TreeCharSet exclusiveElements(const TreeCharSet& set1, const TreeCharSet& set2) {
+        TreeCharSet result;
         for (char element : set1.elements) {
             if (!set2.contains(element)) {
                 result.add(element);
@@ -115,13 +552,80 @@ public:
     }
 };
 
-// Class to manage pairs of CharSet objects
+// Class to manage pairs and collections of CharSet objects
 class SetManager {
+private:
+    // Folds sets[0 .. count) into identity word by word, in one pass with no
+    // intermediate sets. Large inputs are split into contiguous slices, one per
+    // thread, whose partial results are folded the same way.
+    template <typename Op>
+    static CharSet reduce(const CharSet* sets, size_t count, const CharSet& identity, unsigned threadCount, Op op) {
+        size_t slices = max<size_t>(1, min<size_t>(threadCount, count / 65536));
+        vector<CharSet> partial(slices, identity);
+        auto reduceSlice = [&](size_t slice) {
+            array<uint64_t, CharSet::WordCount> words = identity.words;
+            for (size_t i = count * slice / slices; i < count * (slice + 1) / slices; ++i) {
+                for (size_t w = 0; w < CharSet::WordCount; ++w) {
+                    words[w] = op(words[w], sets[i].words[w]);
+                }
+            }
+            partial[slice].words = words;
+        };
+        vector<thread> workers;
+        for (size_t slice = 1; slice < slices; ++slice) {
+            workers.emplace_back(reduceSlice, slice);
+        }
+        reduceSlice(0);
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        CharSet result = partial[0];
+        for (size_t slice = 1; slice < slices; ++slice) {
+            for (size_t w = 0; w < CharSet::WordCount; ++w) {
+                result.words[w] = op(result.words[w], partial[slice].words[w]);
+            }
+        }
+        return result;
+    }
+
+    static CharSet fullSet() {
+        CharSet result;
+        result.words.fill(UINT64_MAX);
+        return result;
+    }
+
 public:
     // Create a new set from a pair of CharSet objects with exclusive elements
     static CharSet createExclusiveSet(const CharSet& set1, const CharSet& set2) {
         return CharSet::exclusiveElements(set1, set2);
     }
+
+    // Elements present in any of sets[0 .. count)
+    static CharSet unionOf(const CharSet* sets, size_t count, unsigned threadCount = 1) {
+        return reduce(sets, count, CharSet(), threadCount, [](uint64_t a, uint64_t b) { return a | b; });
+    }
+
+    // Elements present in all of sets[0 .. count); every character when count is 0
+    static CharSet intersectionOf(const CharSet* sets, size_t count, unsigned threadCount = 1) {
+        return reduce(sets, count, fullSet(), threadCount, [](uint64_t a, uint64_t b) { return a & b; });
+    }
+
+    // Elements present in an odd number of sets[0 .. count)
+    static CharSet symmetricDifferenceOf(const CharSet* sets, size_t count, unsigned threadCount = 1) {
+        return reduce(sets, count, CharSet(), threadCount, [](uint64_t a, uint64_t b) { return a ^ b; });
+    }
+
+    static CharSet unionOf(const vector<CharSet>& sets, unsigned threadCount = 1) {
+        return unionOf(sets.data(), sets.size(), threadCount);
+    }
+
+    static CharSet intersectionOf(const vector<CharSet>& sets, unsigned threadCount = 1) {
+        return intersectionOf(sets.data(), sets.size(), threadCount);
+    }
+
+    static CharSet symmetricDifferenceOf(const vector<CharSet>& sets, unsigned threadCount = 1) {
+        return symmetricDifferenceOf(sets.data(), sets.size(), threadCount);
+    }
 };
 
 // Test adding elements and checking membership
@@ -302,7 +806,468 @@ void testDifferenceWithEmptySet() {
     assert(differenceSet.contains('b') == true);
 }
 
-int main() {
+// Test size and emptiness through popcount
+void testSizeAndEmpty() {
+    CharSet set;
+    assert(set.empty());
+    assert(set.size() == 0);
+
+    set.add('a');
+    set.add('a'); // Adding twice keeps one element
+    set.add(static_cast<char>(200));
+    set.add('\0');
+    assert(!set.empty());
+    assert(set.size() == 3);
+
+    set.remove('a');
+    assert(set.size() == 2);
+}
+
+// Test symmetric difference of two sets
+void testSymmetricDifference() {
+    CharSet setA;
+    CharSet setB;
+    setA.add('a');
+    setA.add('b');
+    setB.add('b');
+    setB.add('c');
+
+    CharSet symmetric = setA.symmetricDifferenceWith(setB);
+    assert(symmetric.size() == 2);
+    assert(symmetric.contains('a') == true);
+    assert(symmetric.contains('b') == false);
+    assert(symmetric.contains('c') == true);
+}
+
+// Test rank and select as inverses of each other
+void testRankAndSelect() {
+    CharSet set;
+    set.add('z');
+    set.add('a');
+    set.add('m');
+    set.add(static_cast<char>(CHAR_MIN));
+    set.add(static_cast<char>(CHAR_MAX));
+
+    assert(set.select(0) == static_cast<char>(CHAR_MIN));
+    assert(set.select(1) == 'a');
+    assert(set.select(3) == 'z');
+    assert(set.select(4) == static_cast<char>(CHAR_MAX));
+    assert(set.rank('a') == 1);
+    assert(set.rank('b') == 2); // Absent elements count what lies below them
+    assert(set.rank(static_cast<char>(CHAR_MIN)) == 0);
+    for (size_t i = 0; i < set.size(); ++i) {
+        assert(set.rank(set.select(i)) == i);
+    }
+
+    try {
+        set.select(5);
+        assert(false); // Should not reach here
+    } catch (const out_of_range& e) {
+        assert(true); // Expected exception
+    }
+}
+
+// Test the bulk scans against one contains() call per character
+void testBulkScanning() {
+    mt19937 random(15);
+    uniform_int_distribution<int> value(CHAR_MIN, CHAR_MAX);
+    for (size_t length : { 0, 1, 31, 32, 33, 64, 100, 5000 }) {
+        for (int members : { 0, 3, 128, 256 }) {
+            CharSet set;
+            for (int i = 0; i < members; ++i) {
+                set.add(static_cast<char>(value(random)));
+            }
+            string text(length, ' ');
+            for (char& c : text) {
+                c = static_cast<char>(value(random));
+            }
+
+            size_t count = 0;
+            size_t first = string_view::npos;
+            size_t span = length;
+            string filtered;
+            for (size_t i = 0; i < length; ++i) {
+                if (set.contains(text[i])) {
+                    ++count;
+                    first = min(first, i);
+                    filtered.push_back(text[i]);
+                } else {
+                    span = min(span, i);
+                }
+            }
+            string out = "prefix";
+            set.filterInto(text, out);
+            assert(set.countIn(text) == count);
+            assert(set.findFirstOf(text) == first);
+            assert(set.spanOf(text) == span);
+            assert(out == "prefix" + filtered);
+        }
+    }
+
+    CharSet vowels;
+    for (char c : string("aeiou")) {
+        vowels.add(c);
+    }
+    assert(vowels.countIn("expression templates") == 7);
+    assert(vowels.findFirstOf("rhythm") == string_view::npos);
+    assert(vowels.spanOf("aeiouxaeiou") == 5);
+}
+
+// Test n-ary reductions against chained pairwise operators, serial and threaded
+void testMultiWayOperations() {
+    mt19937 random(12);
+    uniform_int_distribution<int> value(CHAR_MIN, CHAR_MAX);
+    for (size_t count : { 1, 2, 7, 200000 }) {
+        vector<CharSet> sets(count);
+        for (CharSet& set : sets) {
+            for (int i = 0; i < 250; ++i) {
+                set.add(static_cast<char>(value(random)));
+            }
+        }
+        CharSet unionSet = sets[0];
+        CharSet intersectionSet = sets[0];
+        CharSet exclusiveSet = sets[0];
+        for (size_t i = 1; i < count; ++i) {
+            unionSet = unionSet + sets[i];
+            intersectionSet = intersectionSet * sets[i];
+            exclusiveSet = SetManager::createExclusiveSet(exclusiveSet, sets[i]);
+        }
+        for (unsigned threads : { 1, 4 }) {
+            CharSet unionOf = SetManager::unionOf(sets, threads);
+            CharSet intersectionOf = SetManager::intersectionOf(sets, threads);
+            CharSet exclusiveOf = SetManager::symmetricDifferenceOf(sets, threads);
+            for (int c = CHAR_MIN; c <= CHAR_MAX; ++c) {
+                char element = static_cast<char>(c);
+                assert(unionOf.contains(element) == unionSet.contains(element));
+                assert(intersectionOf.contains(element) == intersectionSet.contains(element));
+                assert(exclusiveOf.contains(element) == exclusiveSet.contains(element));
+            }
+        }
+    }
+
+    vector<CharSet> none;
+    assert(SetManager::unionOf(none).empty());
+    assert(SetManager::intersectionOf(none).size() == 256);
+    assert(SetManager::symmetricDifferenceOf(none).empty());
+}
+
+enum class Permission { Read, Write, Execute, Delete };
+using PermissionUniverse = ValueRange<Permission, Permission::Read, Permission::Delete>;
+
+// Test a DenseSet of enum flags, stored inline in one word
+void testDenseSetEnumFlags() {
+    static_assert(DenseSet<PermissionUniverse>::isInline, "Four flags fit in one word");
+    DenseSet<PermissionUniverse> owner;
+    DenseSet<PermissionUniverse> guest;
+    owner.add(Permission::Read);
+    owner.add(Permission::Write);
+    owner.add(Permission::Delete);
+    guest.add(Permission::Read);
+    guest.add(Permission::Execute);
+
+    assert((owner + guest).size() == 4);
+    assert((owner * guest).size() == 1);
+    assert((owner * guest).contains(Permission::Read));
+    assert((owner - guest).contains(Permission::Write));
+    assert(!(owner - guest).contains(Permission::Read));
+    assert(DenseSet<PermissionUniverse>::exclusiveElements(owner, guest).size() == 3);
+    assert(owner[2] == Permission::Delete);
+    assert(owner.rank(Permission::Delete) == 2);
+}
+
+// Test a DenseSet over 0..4095, stored on the heap, against std::set
+void testDenseSetLargeUniverse() {
+    using Universe = ValueRange<int, 0, 4095>;
+    static_assert(!DenseSet<Universe>::isInline, "4096 values live on the heap");
+    mt19937 random(17);
+    uniform_int_distribution<int> value(0, 4095);
+    DenseSet<Universe> dense;
+    DenseSet<Universe> other;
+    set<int> reference;
+    set<int> otherReference;
+    for (int i = 0; i < 1000; ++i) {
+        int a = value(random);
+        int b = value(random);
+        dense.add(a);
+        reference.insert(a);
+        other.add(b);
+        otherReference.insert(b);
+    }
+    assert(dense.size() == reference.size());
+    size_t index = 0;
+    for (int element : reference) {
+        assert(dense[index] == element);
+        assert(dense.rank(element) == index);
+        ++index;
+    }
+
+    DenseSet<Universe> both = dense * other;
+    DenseSet<Universe> copy = both; // Copies own their bitmap
+    copy.add(4095);
+    for (int v = 0; v < 4096; ++v) {
+        bool inBoth = reference.count(v) > 0 && otherReference.count(v) > 0;
+        assert(both.contains(v) == inBoth);
+        assert((dense + other).contains(v) == (reference.count(v) > 0 || otherReference.count(v) > 0));
+    }
+    assert(copy.contains(4095) && both.contains(4095) == (reference.count(4095) > 0 && otherReference.count(4095) > 0));
+
+    assert(!dense.contains(-1));
+    assert(!dense.contains(4096));
+    try {
+        dense.add(4096);
+        assert(false); // Should not reach here
+    } catch (const out_of_range& e) {
+        assert(true); // Expected exception
+    }
+}
+
+// Test a DenseSet over a Unicode block (Cyrillic, U+0400..U+04FF)
+void testDenseSetCodePointBlock() {
+    using Cyrillic = ValueRange<char32_t, 0x0400, 0x04FF>;
+    static_assert(DenseSet<Cyrillic>::isInline, "A 256-code-point block fits inline");
+    DenseSet<Cyrillic> letters;
+    for (char32_t c : { U'\u0410', U'\u0411', U'\u0412', U'\u0430' }) {
+        letters.add(c);
+    }
+    assert(letters.size() == 4);
+    assert(letters.contains(0x0411));
+    assert(!letters.contains(U'A'));
+    assert(letters[3] == 0x0430);
+    letters.remove(0x0411);
+    letters.remove(U'A'); // Outside the block, nothing to remove
+    assert(letters.size() == 3);
+}
+
+// Fills a bitmap set and a tree set with the same random characters
+void fillRandomSets(CharSet& bitmap, TreeCharSet& tree, mt19937& random, int count) {
+    uniform_int_distribution<int> value(CHAR_MIN, CHAR_MAX);
+    for (int i = 0; i < count; ++i) {
+        char element = static_cast<char>(value(random));
+        bitmap.add(element);
+        tree.add(element);
+    }
+}
+
+// Checks that both sets hold the same characters in the same order
+void assertSameElements(const CharSet& bitmap, const TreeCharSet& tree) {
+    size_t count = 0;
+    for (int c = CHAR_MIN; c <= CHAR_MAX; ++c) {
+        assert(bitmap.contains(static_cast<char>(c)) == tree.contains(static_cast<char>(c)));
+        count += tree.contains(static_cast<char>(c));
+    }
+    assert(bitmap.size() == count);
+    for (size_t i = 0; i < count; ++i) {
+        assert(bitmap[i] == tree[i]);
+        assert(bitmap.rank(bitmap[i]) == i);
+    }
+}
+
+// Test that the bitmap set agrees with the tree set over the whole char range
+void testMatchesTreeCharSet() {
+    mt19937 random(16);
+    for (int round = 0; round < 50; ++round) {
+        CharSet bitmapA, bitmapB;
+        TreeCharSet treeA, treeB;
+        fillRandomSets(bitmapA, treeA, random, round * 5);
+        fillRandomSets(bitmapB, treeB, random, 100);
+
+        assertSameElements(bitmapA, treeA);
+        assertSameElements(bitmapA + bitmapB, treeA + treeB);
+        assertSameElements(bitmapA * bitmapB, treeA * treeB);
+        assertSameElements(bitmapA - bitmapB, treeA - treeB);
+        assertSameElements(CharSet::exclusiveElements(bitmapA, bitmapB), TreeCharSet::exclusiveElements(treeA, treeB));
+    }
+}
+
+// Benchmarks
+
+// Returns the seconds one call of op takes, averaged over at least 0.1 s.
+template <typename Op>
+double measureSeconds(Op op) {
+    size_t calls = 0;
+    auto start = chrono::steady_clock::now();
+    chrono::duration<double> elapsed{ 0 };
+    for (size_t batch = 1; elapsed.count() < 0.1; batch *= 2) {
+        for (size_t i = 0; i < batch; ++i) {
+            op();
+        }
+        calls += batch;
+        elapsed = chrono::steady_clock::now() - start;
+    }
+    return elapsed.count() / calls;
+}
+
+// Times one set operation over every adjacent pair of sets, in ns per pair;
+// op returns something cheap derived from its result so it is not optimized away
+template <typename Set, typename Op>
+double measurePairs(const vector<Set>& sets, size_t& sink, Op op) {
+    double seconds = measureSeconds([&] {
+        for (size_t i = 0; i + 1 < sets.size(); ++i) {
+            sink += op(sets[i], sets[i + 1]);
+        }
+    });
+    return seconds / (sets.size() - 1) * 1e9;
+}
+
+// Compares the bitmap set with the tree set on random sets of 64 draws
+template <typename Set>
+void benchmarkSetKind(const char* name, const vector<Set>& sets) {
+    size_t hits = 0;
+    double lookup = measureSeconds([&] {
+        for (const Set& set : sets) {
+            for (int c = CHAR_MIN; c <= CHAR_MAX; ++c) {
+                hits += set.contains(static_cast<char>(c));
+            }
+        }
+    }) / (sets.size() * 256) * 1e9;
+    // Indexed iteration walks every element through operator[]
+    vector<size_t> sizes;
+    size_t elements = 0;
+    for (const Set& set : sets) {
+        size_t count = 0;
+        for (int c = CHAR_MIN; c <= CHAR_MAX; ++c) {
+            count += set.contains(static_cast<char>(c));
+        }
+        sizes.push_back(count);
+        elements += count;
+    }
+    double indexed = measureSeconds([&] {
+        for (size_t k = 0; k < sets.size(); ++k) {
+            for (size_t i = 0; i < sizes[k]; ++i) {
+                hits += sets[k][i];
+            }
+        }
+    }) / elements * 1e9;
+    cout << "  " << name << ": contains " << lookup << ", [] " << indexed
+         << ", + " << measurePairs(sets, hits, [](const Set& a, const Set& b) { return (a + b).contains('a'); })
+         << ", * " << measurePairs(sets, hits, [](const Set& a, const Set& b) { return (a * b).contains('a'); })
+         << ", - " << measurePairs(sets, hits, [](const Set& a, const Set& b) { return (a - b).contains('a'); })
+         << ", exclusive " << measurePairs(sets, hits, [](const Set& a, const Set& b) { return Set::exclusiveElements(a, b).contains('a'); })
+         << (hits == 0 ? " " : "") << "\n";
+}
+
+void benchmarkCharSet() {
+    const size_t count = 1000;
+    vector<CharSet> bitmaps(count);
+    vector<TreeCharSet> trees(count);
+    mt19937 random(42);
+    for (size_t i = 0; i < count; ++i) {
+        fillRandomSets(bitmaps[i], trees[i], random, 64);
+    }
+    cout << "CharSet benchmark (ns per operation):\n";
+    benchmarkSetKind("bitmap", bitmaps);
+    benchmarkSetKind("tree", trees);
+    cout.flush();
+}
+
+// Scans 16 MB of text against a set of punctuation, in GB/s
+void benchmarkBulkScanning() {
+    const size_t length = 16 << 20;
+    mt19937 random(7);
+    uniform_int_distribution<int> printable(32, 126);
+    string text(length, ' ');
+    for (char& c : text) {
+        c = static_cast<char>(printable(random));
+    }
+    CharSet punctuation;
+    for (char c : string(".,;:!?'\"()-")) {
+        punctuation.add(c);
+    }
+    CharSet absent; // Never found, so find and span run to the end
+    absent.add('\n');
+    CharSet printableSet;
+    for (int c = 32; c <= 126; ++c) {
+        printableSet.add(static_cast<char>(c));
+    }
+
+    size_t sink = 0;
+    string out;
+    out.reserve(length);
+    auto rate = [&](auto op) { return length / measureSeconds(op) / 1e9; };
+    double loop = rate([&] {
+        for (char c : text) {
+            sink += punctuation.contains(c);
+        }
+    });
+    double count = rate([&] { sink += punctuation.countIn(text); });
+    double find = rate([&] { sink += absent.findFirstOf(text); });
+    double span = rate([&] { sink += printableSet.spanOf(text); });
+    double filter = rate([&] {
+        out.clear();
+        punctuation.filterInto(text, out);
+    });
+    cout << "Bulk scanning benchmark (GB/s): contains loop " << loop << ", countIn " << count
+         << ", findFirstOf " << find << ", spanOf " << span << ", filterInto " << filter
+         << (sink == 0 ? " " : "") << endl;
+}
+
+// Reduces a million sets by chaining pairwise operators and with the n-ary
+// SetManager reductions, serial and on every hardware thread, in ms
+void benchmarkMultiWayOperations() {
+    const size_t count = 1 << 20;
+    vector<CharSet> sets(count);
+    mt19937 random(3);
+    uniform_int_distribution<int> value(CHAR_MIN, CHAR_MAX);
+    for (CharSet& set : sets) {
+        for (int i = 0; i < 64; ++i) {
+            set.add(static_cast<char>(value(random)));
+        }
+    }
+    unsigned threads = max(1u, thread::hardware_concurrency());
+    size_t sink = 0;
+    double chained = measureSeconds([&] {
+        CharSet result;
+        for (const CharSet& set : sets) {
+            result = result + set;
+        }
+        sink += result.size();
+    });
+    double serial = measureSeconds([&] { sink += SetManager::unionOf(sets).size(); });
+    double parallel = measureSeconds([&] { sink += SetManager::unionOf(sets, threads).size(); });
+    cout << "Multi-way union of " << count << " sets (ms): chained + " << chained * 1e3
+         << ", unionOf " << serial * 1e3 << ", unionOf on " << threads << " threads " << parallel * 1e3
+         << (sink == 0 ? " " : "") << endl;
+}
+
+// Times contains, + and * on random quarter-full DenseSets over Universe, in ns
+template <typename Universe>
+void benchmarkDenseSet(const char* name) {
+    const size_t count = 256;
+    vector<DenseSet<Universe>> sets(count);
+    mt19937 random(5);
+    uniform_int_distribution<size_t> index(0, Universe::size - 1);
+    for (auto& set : sets) {
+        for (size_t i = 0; i < Universe::size / 4; ++i) {
+            set.add(Universe::value(index(random)));
+        }
+    }
+    size_t hits = 0;
+    double lookup = measureSeconds([&] {
+        for (const auto& set : sets) {
+            for (size_t i = 0; i < Universe::size; i += 7) {
+                hits += set.contains(Universe::value(i));
+            }
+        }
+    }) / (count * ((Universe::size + 6) / 7)) * 1e9;
+    using Set = DenseSet<Universe>;
+    cout << "  " << name << " (" << Universe::size << " values, " << (Set::isInline ? "inline" : "heap")
+         << "): contains " << lookup
+         << ", + " << measurePairs(sets, hits, [](const Set& a, const Set& b) { return (a + b).empty(); })
+         << ", * " << measurePairs(sets, hits, [](const Set& a, const Set& b) { return (a * b).empty(); })
+         << (hits == 0 ? " " : "") << "\n";
+}
+
+void benchmarkDenseSets() {
+    cout << "DenseSet benchmark (ns per operation):\n";
+    benchmarkDenseSet<PermissionUniverse>("enum flags");
+    benchmarkDenseSet<ValueRange<char, CHAR_MIN, CHAR_MAX>>("char");
+    benchmarkDenseSet<ValueRange<int, 0, 4095>>("0..4095");
+    benchmarkDenseSet<ValueRange<char32_t, 0, 0xFFFF>>("Basic Multilingual Plane");
+    cout.flush();
+}
+
+// Main function to run tests (pass --bench to also run the benchmarks)
+int main(int argc, char** argv) {
     testAddAndContains();
     testRemove();
     testUnion();
@@ -316,7 +1281,23 @@ int main() {
     testIntersectionWithEmptySet();
     testUnionWithEmptySet();
     testDifferenceWithEmptySet();
+    testSizeAndEmpty();
+    testSymmetricDifference();
+    testRankAndSelect();
+    testBulkScanning();
+    testMultiWayOperations();
+    testDenseSetEnumFlags();
+    testDenseSetLargeUniverse();
+    testDenseSetCodePointBlock();
+    testMatchesTreeCharSet();
 
     cout << "All tests passed!" << endl;
+
+    if (argc > 1 && string(argv[1]) == "--bench") {
+        benchmarkCharSet();
+        benchmarkBulkScanning();
+        benchmarkMultiWayOperations();
+        benchmarkDenseSets();
+    }
     return 0;
 }
\ No newline at end of file
@@ -6,66 +6,329 @@
 #include <sstream>
 #include <functional>
 #include <chrono>
+#include <string_view>
+#include <unordered_map>
+#include <array>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+#include <stdexcept>
+#include <algorithm>
+#include <unordered_set>
+#include <queue>
+#include <random>
+#include <cmath>
+#include <atomic>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <memory_resource>
+#include <initializer_list>
+#include <fstream>
+#include <thread>
+#include <exception>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
 
 
 using namespace std;
 
+// Process-wide symbol table behind Word. Every distinct string is stored once,
+// with its hash, under a dense 32-bit id. Entries are never removed, so ids
+// and the string_views handed out stay valid for the whole run. Interning
+// takes a lock; reading an entry by id does not.
+class WordTable {
+private:
+    struct Entry {
+        string_view text;
+        size_t hash;
+    };
+
+    // Block b holds FirstBlockSize << b entries, so BlockCount blocks cover
+    // every 32-bit id and a block never moves once allocated
+    static constexpr size_t FirstBlockBits = 10;
+    static constexpr size_t FirstBlockSize = size_t(1) << FirstBlockBits;
+    static constexpr size_t BlockCount = 33 - FirstBlockBits;
+    static constexpr size_t ChunkSize = 64 * 1024;
+
+    array<unique_ptr<Entry[]>, BlockCount> blocks;
+    size_t count = 0;
+    unordered_map<string_view, uint32_t> ids;
+    vector<unique_ptr<char[]>> chunks; // Word bytes, ChunkSize or more each
+    char* chunkNext = nullptr;
+    size_t chunkFree = 0;
+    size_t chunkBytes = 0;
+    mutex lock;
+
+    // floor(log2(position)) for position > 0
+    static size_t blockOf(uint64_t position) {
+#if defined(_MSC_VER)
+        unsigned long bit;
+        _BitScanReverse64(&bit, position);
+        return bit;
+#else
+        return 63 - __builtin_clzll(position);
+#endif
+    }
+
+    // Slot of an id below count (or of the next id once its block exists)
+    Entry& slot(uint32_t id) const {
+        size_t block = blockOf(uint64_t(id) / FirstBlockSize + 1);
+        size_t offset = static_cast<size_t>(uint64_t(id) + FirstBlockSize - (FirstBlockSize << block));
+        return blocks[block][offset];
+    }
+
+    string_view store(string_view text) {
+        if (text.size() > chunkFree) {
+            size_t size = max(ChunkSize, text.size());
+            chunks.push_back(make_unique<char[]>(size));
+            chunkNext = chunks.back().get();
+            chunkFree = size;
+            chunkBytes += size;
+        }
+        char* data = chunkNext;
+        copy(text.begin(), text.end(), data);
+        chunkNext += text.size();
+        chunkFree -= text.size();
+        return string_view(data, text.size());
+    }
+
+public:
+    // The table shared by every Word
+    static WordTable& global() {
+        static WordTable table;
+        return table;
+    }
+
+    // Id of text, adding it on first use
+    uint32_t intern(string_view text) {
+        lock_guard<mutex> guard(lock);
+        auto found = ids.find(text);
+        if (found != ids.end()) {
+            return found->second;
+        }
+        if (count > UINT32_MAX) {
+            throw length_error("Too many distinct words.");
+        }
+        uint32_t id = static_cast<uint32_t>(count);
+        size_t block = blockOf(uint64_t(id) / FirstBlockSize + 1);
+        if (!blocks[block]) {
+            blocks[block] = make_unique<Entry[]>(FirstBlockSize << block);
+        }
+        string_view stored = store(text);
+        slot(id) = Entry{ stored, std::hash<string_view>()(stored) };
+        ids.emplace(stored, id);
+        ++count;
+        return id;
+    }
+
+    string_view text(uint32_t id) const {
+        return slot(id).text;
+    }
+
+    size_t hash(uint32_t id) const {
+        return slot(id).hash;
+    }
+
+    // Number of distinct words
+    size_t size() {
+        lock_guard<mutex> guard(lock);
+        return count;
+    }
+
+    // Approximate bytes held by the table: entries, word bytes and the lookup map
+    size_t memoryFootprint() {
+        lock_guard<mutex> guard(lock);
+        size_t entryBytes = 0;
+        for (size_t block = 0; block < BlockCount && blocks[block]; ++block) {
+            entryBytes += (FirstBlockSize << block) * sizeof(Entry);
+        }
+        size_t mapBytes = ids.bucket_count() * sizeof(void*) +
+                          ids.size() * (sizeof(pair<const string_view, uint32_t>) + 2 * sizeof(void*));
+        return entryBytes + chunkBytes + mapBytes;
+    }
+};
+
+// A word is an id into WordTable::global(): copies and comparisons are integer
+// operations, and the text and its hash are looked up, never recomputed
 class Word {
 private:
-    string value;
+    uint32_t id;
+
+    Word() = default;
 
 public:
-    Word(const string& value) : value(value) {}
+    Word(string_view value) : id(WordTable::global().intern(value)) {}
+
+    // The word with an id previously returned by getId()
+    static Word fromId(uint32_t id) {
+        Word word;
+        word.id = id;
+        return word;
+    }
 
 
-    void setValue(const string& newValue) {
-        value = newValue;
+    void setValue(string_view newValue) {
+        id = WordTable::global().intern(newValue);
     }
 
     string toString() const {
-        return value;
+        return string(toStringView());
+    }
+
+    // The interned text, without copying
+    string_view toStringView() const {
+        return WordTable::global().text(id);
+    }
+
+    uint32_t getId() const {
+        return id;
+    }
+
+    // Number of characters renderTo writes
+    size_t renderedLength() const {
+        return toStringView().size();
+    }
+
+    // Writes the word to out and returns the position after it
+    template <typename Output>
+    Output renderTo(Output out) const {
+        string_view text = toStringView();
+        return copy(text.begin(), text.end(), out);
+    }
+
+    // Appends the word to out, growing it at most once
+    void appendTo(string& out) const {
+        out.append(toStringView());
     }
 
     bool equals(const Word& other) const { 
-        return value == other.value;
+        return id == other.id;
     }
 
     size_t hashCode() const {
-        return hash<string>()(value);
+        return WordTable::global().hash(id);
+    }
+};
+
+// Reserves room for the elements of [first, last) when that is cheap to count
+template <typename Container, typename Iterator>
+void reserveFor(Container& container, Iterator first, Iterator last) {
+    if constexpr (is_base_of_v<forward_iterator_tag, typename iterator_traits<Iterator>::iterator_category>) {
+        container.reserve(container.size() + static_cast<size_t>(distance(first, last)));
+    }
+}
+
+// Order-sensitive rolling hash of a word sequence, shared by Sentence and SentenceView
+struct SentenceHash {
+    static constexpr uint64_t Empty = 0x6A09E667F3BCC909;
+    static constexpr uint64_t Multiplier = 0x9E3779B97F4A7C15;
+
+    // Folds one more word into a rolling hash: hash * M + mix(word). Each
+    // position is weighted by a different power of M, so word order matters and
+    // repeated words never cancel; mixing spreads weak std::hash values first.
+    static uint64_t extend(uint64_t hash, const Word& word) {
+        uint64_t mixed = word.hashCode();
+        mixed = (mixed ^ (mixed >> 30)) * 0xBF58476D1CE4E5B9;
+        mixed = (mixed ^ (mixed >> 27)) * 0x94D049BB133111EB;
+        mixed ^= mixed >> 31;
+        return hash * Multiplier + mixed;
     }
 };
 
+// Length of words[0 .. count) rendered with one space between each
+inline size_t renderedLength(const Word* words, size_t count) {
+    size_t length = count == 0 ? 0 : count - 1;
+    for (size_t i = 0; i < count; ++i) {
+        length += words[i].renderedLength();
+    }
+    return length;
+}
+
+// Writes words[0 .. count) separated by spaces and returns the position after them
+template <typename Output>
+Output renderWords(const Word* words, size_t count, Output out) {
+    for (size_t i = 0; i < count; ++i) {
+        if (i > 0) {
+            *out++ = ' ';
+        }
+        out = words[i].renderTo(out);
+    }
+    return out;
+}
+
 class Sentence {
 private:
     vector<Word> words;
+    uint64_t hash = SentenceHash::Empty; // Rolling hash of words, kept up to date by every mutator
 
 public:
     void addWord(const Word& word) { 
         words.push_back(word);
+        hash = SentenceHash::extend(hash, word);
+    }
+
+    // Constructs a word in place from its text (or anything Word accepts)
+    template <typename... Args>
+    const Word& emplaceWord(Args&&... args) {
+        const Word& word = words.emplace_back(forward<Args>(args)...);
+        hash = SentenceHash::extend(hash, word);
+        return word;
+    }
+
+    // Appends a word for every element of [first, last), reserving once
+    template <typename Iterator>
+    void appendWords(Iterator first, Iterator last) {
+        reserveFor(words, first, last);
+        for (; first != last; ++first) {
+            emplaceWord(*first);
+        }
+    }
+
+    void reserve(size_t wordCount) {
+        words.reserve(wordCount);
     }
 
     string toString() const {
         string result;
-        for (const auto& word : words) {
-            result += word.toString() + " ";
-        }
-        return result.empty() ? result : result.substr(0, result.size() - 1);
+        appendTo(result);
+        return result;
+    }
+
+    // Number of characters renderTo writes: the words and one space between each
+    size_t renderedLength() const {
+        return ::renderedLength(words.data(), words.size());
+    }
+
+    // Writes the words separated by spaces to out and returns the position after them
+    template <typename Output>
+    Output renderTo(Output out) const {
+        return renderWords(words.data(), words.size(), out);
+    }
+
+    // Appends the sentence to out, growing it at most once
+    void appendTo(string& out) const {
+        size_t start = out.size();
+        out.resize(start + renderedLength());
+        renderTo(&out[0] + start);
     }
 
     bool equals(const Sentence& other) const {
-        if (words.size() != other.words.size()) return false;
+        if (hash != other.hash || words.size() != other.words.size()) return false;
         for (size_t i = 0; i < words.size(); ++i) {
             if (!words[i].equals(other.words[i])) return false;
         }
         return true;
     }
 
+    // Cached order-sensitive hash, O(1)
     size_t hashCode() const {
-        size_t hash = 0;
-        for (const auto& word : words) {
-            hash ^= word.hashCode(); 
-        }
-        return hash;
+        return static_cast<size_t>(hash);
     }
 
     const vector<Word>& getWords() const {
@@ -73,7 +336,15 @@ public:
     }
 
     void setWords(const vector<Word>& newWords) {
-        words = newWords;
+        setWords(vector<Word>(newWords));
+    }
+
+    void setWords(vector<Word>&& newWords) {
+        words = move(newWords);
+        hash = SentenceHash::Empty;
+        for (const auto& word : words) {
+            hash = SentenceHash::extend(hash, word);
+        }
     }
 };
 
@@ -95,13 +366,44 @@ public:
 class TextService {
 public:
     static string printText(const string& title, const vector<Sentence>& sentences) { 
-        ostringstream oss;
-        oss << "Title: " << title << "\n";
+        string result;
+        appendText(title, sentences, result);
+        return result;
+    }
+
+    // Number of characters renderText writes: a title line and one line per sentence
+    template <typename Sentences>
+    static size_t renderedLength(string_view title, const Sentences& sentences) {
+        size_t length = TitlePrefix.size() + title.size() + 1 + sentences.size();
+        for (const auto& sentence : sentences) {
+            length += sentence.renderedLength();
+        }
+        return length;
+    }
+
+    // Writes the text as printText formats it and returns the position after it
+    template <typename Sentences, typename Output>
+    static Output renderText(string_view title, const Sentences& sentences, Output out) {
+        out = copy(TitlePrefix.begin(), TitlePrefix.end(), out);
+        out = copy(title.begin(), title.end(), out);
+        *out++ = '\n';
         for (const auto& sentence : sentences) {
-            oss << SentenceService::toString(sentence) << "\n";
+            out = sentence.renderTo(out);
+            *out++ = '\n';
         }
-        return oss.str();
+        return out;
+    }
+
+    // Appends the text to out, growing it at most once
+    template <typename Sentences>
+    static void appendText(string_view title, const Sentences& sentences, string& out) {
+        size_t start = out.size();
+        out.resize(start + renderedLength(title, sentences));
+        renderText(title, sentences, &out[0] + start);
     }
+
+private:
+    static constexpr string_view TitlePrefix = "Title: ";
 };
 
 class Text {
@@ -116,6 +418,29 @@ public:
         sentences.push_back(sentence);
     }
 
+    void addSentence(Sentence&& sentence) {
+        sentences.push_back(move(sentence));
+    }
+
+    // Constructs an empty sentence in place and returns it for filling
+    Sentence& emplaceSentence() {
+        return sentences.emplace_back();
+    }
+
+    // Appends a sentence for every range of words in [first, last), each built
+    // in place with room reserved once
+    template <typename Iterator>
+    void appendSentences(Iterator first, Iterator last) {
+        reserveFor(sentences, first, last);
+        for (; first != last; ++first) {
+            emplaceSentence().appendWords(begin(*first), end(*first));
+        }
+    }
+
+    void reserve(size_t sentenceCount) {
+        sentences.reserve(sentenceCount);
+    }
+
     string getTitle() const {
         return title;
     }
@@ -128,6 +453,22 @@ public:
         return TextService::printText(title, sentences);
     }
 
+    // Number of characters toString returns
+    size_t renderedLength() const {
+        return TextService::renderedLength(title, sentences);
+    }
+
+    // Writes the text as toString formats it and returns the position after it
+    template <typename Output>
+    Output renderTo(Output out) const {
+        return TextService::renderText(title, sentences, out);
+    }
+
+    // Appends the text to out, growing it at most once
+    void appendTo(string& out) const {
+        TextService::appendText(title, sentences, out);
+    }
+
     const vector<Sentence>& getSentences() const {
         return sentences;
     }
@@ -135,6 +476,859 @@ public:
     void setSentences(const vector<Sentence>& newSentences) {
         sentences = newSentences;
     }
+
+    void setSentences(vector<Sentence>&& newSentences) {
+        sentences = move(newSentences);
+    }
+
+    // Removes every sentence equal to an earlier one, keeping the order of the
+    // rest, and returns how many were removed. Expected O(n) via SentenceIndex.
+    size_t dedup(unsigned threadCount = 1);
+};
+
+// Open-addressing hash index over the sentences of a Text, mapping each
+// distinct sentence to the position of its first occurrence. A slot packs the
+// high half of the cached sentence hash with position + 1, so probing rarely
+// touches a sentence whose hash differs. The index refers to the Text's
+// sentences and must be rebuilt after the Text changes.
+class SentenceIndex {
+private:
+    static constexpr uint64_t PositionMask = 0xFFFFFFFFull;
+
+    const vector<Sentence>* sentences;
+    vector<atomic<uint64_t>> slots; // 0 when empty
+    size_t mask = 0;
+    size_t count = 0;
+
+    static uint64_t tagOf(uint64_t hash) {
+        return hash & ~PositionMask;
+    }
+
+    static size_t positionOf(uint64_t entry) {
+        return static_cast<size_t>((entry & PositionMask) - 1);
+    }
+
+    // Inserts sentences[position], or lowers the position stored for an equal
+    // sentence; Concurrent selects compare-and-swap so threads may insert at once
+    template <bool Concurrent>
+    void insert(size_t position) {
+        const Sentence& sentence = (*sentences)[position];
+        uint64_t hash = sentence.hashCode();
+        uint64_t entry = tagOf(hash) | (position + 1);
+        for (size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+            uint64_t current = slots[slot].load(memory_order_relaxed);
+            while (true) {
+                if (current != 0 && (tagOf(current) != tagOf(hash) || !sentence.equals((*sentences)[positionOf(current)]))) {
+                    break;
+                }
+                if (current != 0 && positionOf(current) < position) {
+                    return;
+                }
+                if (!Concurrent) {
+                    slots[slot].store(entry, memory_order_relaxed);
+                    return;
+                }
+                if (slots[slot].compare_exchange_weak(current, entry, memory_order_relaxed)) {
+                    return;
+                }
+            }
+        }
+    }
+
+public:
+    static constexpr size_t npos = SIZE_MAX;
+
+    // Indexes the sentences of text. Above 64K sentences per thread the
+    // insertions are spread over up to threadCount threads sharing one table.
+    explicit SentenceIndex(const Text& text, unsigned threadCount = 1) : sentences(&text.getSentences()) {
+        size_t size = sentences->size();
+        if (size >= PositionMask) {
+            throw length_error("Too many sentences to index");
+        }
+        size_t capacity = 16;
+        while (capacity < size * 2) {
+            capacity *= 2;
+        }
+        slots = vector<atomic<uint64_t>>(capacity);
+        mask = capacity - 1;
+
+        size_t slices = max<size_t>(1, min<size_t>(threadCount, size / 65536));
+        if (slices == 1) {
+            for (size_t i = 0; i < size; ++i) {
+                insert<false>(i);
+            }
+        } else {
+            vector<thread> workers;
+            for (size_t slice = 0; slice < slices; ++slice) {
+                workers.emplace_back([this, slice, slices, size] {
+                    for (size_t i = size * slice / slices, end = size * (slice + 1) / slices; i < end; ++i) {
+                        insert<true>(i);
+                    }
+                });
+            }
+            for (auto& worker : workers) {
+                worker.join();
+            }
+        }
+        for (const auto& slot : slots) {
+            count += slot.load(memory_order_relaxed) != 0;
+        }
+    }
+
+    // Position of the first sentence equal to sentence, or npos
+    size_t find(const Sentence& sentence) const {
+        uint64_t hash = sentence.hashCode();
+        for (size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+            uint64_t current = slots[slot].load(memory_order_relaxed);
+            if (current == 0) {
+                return npos;
+            }
+            if (tagOf(current) == tagOf(hash) && sentence.equals((*sentences)[positionOf(current)])) {
+                return positionOf(current);
+            }
+        }
+    }
+
+    bool contains(const Sentence& sentence) const {
+        return find(sentence) != npos;
+    }
+
+    // Number of distinct sentences
+    size_t size() const {
+        return count;
+    }
+};
+
+inline size_t Text::dedup(unsigned threadCount) {
+    vector<bool> keep(sentences.size());
+    {
+        SentenceIndex index(*this, threadCount);
+        for (size_t i = 0; i < sentences.size(); ++i) {
+            keep[i] = index.find(sentences[i]) == i;
+        }
+    }
+    size_t kept = 0;
+    for (size_t i = 0; i < sentences.size(); ++i) {
+        if (keep[i]) {
+            if (kept != i) {
+                sentences[kept] = move(sentences[i]);
+            }
+            ++kept;
+        }
+    }
+    size_t removed = sentences.size() - kept;
+    sentences.erase(sentences.begin() + kept, sentences.end());
+    return removed;
+}
+
+// Inverted index from word id to the ids (positions) of the sentences that
+// contain the word. A posting list is kept in blocks of 64 ids: a skip entry
+// holds each block's first id and the byte offset of the varint-encoded gaps
+// to the rest, so a Cursor can gallop over whole blocks without decoding them.
+class WordIndex {
+private:
+    static constexpr size_t BlockSize = 64;
+
+    struct Skip {
+        uint32_t first;
+        uint32_t offset;
+    };
+
+    struct Postings {
+        vector<uint8_t> gaps;
+        vector<Skip> skips;
+        uint32_t last = 0;
+        uint32_t count = 0;
+    };
+
+    unordered_map<uint32_t, Postings> postings; // By word id, only for words of this index
+    uint32_t sentenceCount = 0;
+
+    static void appendVarint(vector<uint8_t>& out, uint32_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    static uint32_t readVarint(const uint8_t*& in) {
+        uint32_t value = 0;
+        for (int shift = 0;; shift += 7) {
+            uint8_t byte = *in++;
+            value |= uint32_t(byte & 0x7F) << shift;
+            if (byte < 0x80) {
+                return value;
+            }
+        }
+    }
+
+    void addPosting(uint32_t wordId, uint32_t sentenceId) {
+        Postings& list = postings[wordId];
+        if (list.count > 0 && list.last == sentenceId) {
+            return; // The word repeats within the sentence
+        }
+        if (list.count % BlockSize == 0) {
+            list.skips.push_back({ sentenceId, static_cast<uint32_t>(list.gaps.size()) });
+        } else {
+            appendVarint(list.gaps, sentenceId - list.last);
+        }
+        list.last = sentenceId;
+        ++list.count;
+    }
+
+    const Postings* postingsOf(const Word& word) const {
+        auto found = postings.find(word.getId());
+        return found != postings.end() ? &found->second : nullptr;
+    }
+
+public:
+    // Forward iterator over one posting list in increasing sentence id order
+    class Cursor {
+    private:
+        const Postings* list;
+        size_t index = 0;
+        const uint8_t* next = nullptr;
+        uint32_t current = 0;
+
+        void loadBlock(size_t block) {
+            index = block * BlockSize;
+            current = list->skips[block].first;
+            next = list->gaps.data() + list->skips[block].offset;
+        }
+
+    public:
+        explicit Cursor(const Postings& list) : list(&list) {
+            if (list.count > 0) {
+                loadBlock(0);
+            }
+        }
+
+        bool done() const {
+            return index >= list->count;
+        }
+
+        uint32_t value() const {
+            return current;
+        }
+
+        size_t size() const {
+            return list->count;
+        }
+
+        void advance() {
+            if (++index < list->count) {
+                if (index % BlockSize == 0) {
+                    loadBlock(index / BlockSize);
+                } else {
+                    current += readVarint(next);
+                }
+            }
+        }
+
+        // Moves to the first id not less than target: gallops over the skips
+        // of the following blocks, then decodes within the block found
+        void seek(uint32_t target) {
+            if (done() || current >= target) {
+                return;
+            }
+            const vector<Skip>& skips = list->skips;
+            size_t block = index / BlockSize;
+            if (block + 1 < skips.size() && skips[block + 1].first <= target) {
+                size_t low = block + 1, step = 1, high = low + 1;
+                while (high < skips.size() && skips[high].first <= target) {
+                    low = high;
+                    step *= 2;
+                    high = low + step;
+                }
+                high = min(high, skips.size());
+                auto found = upper_bound(skips.begin() + low + 1, skips.begin() + high, target,
+                                         [](uint32_t value, const Skip& skip) { return value < skip.first; });
+                loadBlock(static_cast<size_t>(found - skips.begin()) - 1);
+            }
+            while (!done() && current < target) {
+                advance();
+            }
+        }
+    };
+
+    WordIndex() = default;
+
+    explicit WordIndex(const Text& text) {
+        for (const auto& sentence : text.getSentences()) {
+            addSentence(sentence);
+        }
+    }
+
+    // Indexes sentence under the next sentence id and returns that id
+    uint32_t addSentence(const Sentence& sentence) {
+        if (sentenceCount == UINT32_MAX) {
+            throw length_error("Too many sentences to index");
+        }
+        for (const auto& word : sentence.getWords()) {
+            addPosting(word.getId(), sentenceCount);
+        }
+        return sentenceCount++;
+    }
+
+    size_t size() const {
+        return sentenceCount;
+    }
+
+    // Number of sentences containing word
+    size_t frequency(const Word& word) const {
+        const Postings* list = postingsOf(word);
+        return list ? list->count : 0;
+    }
+
+    // Ids of the sentences containing word, ascending
+    vector<uint32_t> sentencesWith(const Word& word) const {
+        vector<uint32_t> result;
+        if (const Postings* list = postingsOf(word)) {
+            result.reserve(list->count);
+            for (Cursor cursor(*list); !cursor.done(); cursor.advance()) {
+                result.push_back(cursor.value());
+            }
+        }
+        return result;
+    }
+
+    // Ids of the sentences containing every word, ascending. The shortest list
+    // leads and the others seek to its candidates, so the cost follows the
+    // rarest word rather than the longest list.
+    vector<uint32_t> allOf(const vector<Word>& words) const {
+        vector<uint32_t> result;
+        vector<Cursor> cursors;
+        for (const auto& word : words) {
+            const Postings* list = postingsOf(word);
+            if (!list || list->count == 0) {
+                return result;
+            }
+            cursors.emplace_back(*list);
+        }
+        if (cursors.empty()) {
+            return result;
+        }
+        sort(cursors.begin(), cursors.end(), [](const Cursor& a, const Cursor& b) { return a.size() < b.size(); });
+
+        Cursor& lead = cursors[0];
+        while (!lead.done()) {
+            uint32_t candidate = lead.value();
+            bool matched = true;
+            for (size_t i = 1; i < cursors.size(); ++i) {
+                cursors[i].seek(candidate);
+                if (cursors[i].done()) {
+                    return result;
+                }
+                if (cursors[i].value() != candidate) {
+                    lead.seek(cursors[i].value());
+                    matched = false;
+                    break;
+                }
+            }
+            if (matched) {
+                result.push_back(candidate);
+                lead.advance();
+            }
+        }
+        return result;
+    }
+
+    // Ids of the sentences containing at least one of the words, ascending.
+    // One k-way merge over the cursors, kept in a min-heap by current id.
+    vector<uint32_t> anyOf(const vector<Word>& words) const {
+        vector<Cursor> cursors;
+        size_t total = 0;
+        for (const auto& word : words) {
+            const Postings* list = postingsOf(word);
+            if (list && list->count > 0) {
+                cursors.emplace_back(*list);
+                total += list->count;
+            }
+        }
+        auto later = [&](size_t a, size_t b) { return cursors[a].value() > cursors[b].value(); };
+        priority_queue<size_t, vector<size_t>, decltype(later)> heap(later);
+        for (size_t i = 0; i < cursors.size(); ++i) {
+            heap.push(i);
+        }
+
+        vector<uint32_t> result;
+        result.reserve(total);
+        while (!heap.empty()) {
+            size_t i = heap.top();
+            heap.pop();
+            if (result.empty() || result.back() != cursors[i].value()) {
+                result.push_back(cursors[i].value());
+            }
+            cursors[i].advance();
+            if (!cursors[i].done()) {
+                heap.push(i);
+            }
+        }
+        return result;
+    }
+
+    // Bytes held by the posting lists
+    size_t memoryFootprint() const {
+        size_t bytes = postings.bucket_count() * sizeof(void*) +
+                       postings.size() * (sizeof(pair<const uint32_t, Postings>) + sizeof(void*));
+        for (const auto& entry : postings) {
+            bytes += entry.second.gaps.capacity() + entry.second.skips.capacity() * sizeof(Skip);
+        }
+        return bytes;
+    }
+};
+
+// Text whose WordIndex is updated as each sentence is added
+class IndexedText {
+private:
+    Text text;
+    WordIndex index;
+
+public:
+    IndexedText(const string& title) : text(title) {}
+
+    void addSentence(const Sentence& sentence) {
+        text.addSentence(sentence);
+        index.addSentence(text.getSentences().back());
+    }
+
+    void addSentence(Sentence&& sentence) {
+        text.addSentence(move(sentence));
+        index.addSentence(text.getSentences().back());
+    }
+
+    void reserve(size_t sentenceCount) {
+        text.reserve(sentenceCount);
+    }
+
+    const Text& getText() const {
+        return text;
+    }
+
+    const WordIndex& getIndex() const {
+        return index;
+    }
+};
+
+// Read-only sentence of an ArenaText. Its words live in the document's arena,
+// so a view is two pointers' worth of data plus the cached sentence hash.
+class SentenceView {
+private:
+    const Word* words;
+    size_t count;
+    uint64_t hash;
+
+public:
+    SentenceView(const Word* words, size_t count, uint64_t hash) : words(words), count(count), hash(hash) {}
+
+    size_t size() const {
+        return count;
+    }
+
+    const Word& operator[](size_t index) const {
+        return words[index];
+    }
+
+    const Word* begin() const {
+        return words;
+    }
+
+    const Word* end() const {
+        return words + count;
+    }
+
+    string toString() const {
+        string result;
+        appendTo(result);
+        return result;
+    }
+
+    // Number of characters renderTo writes: the words and one space between each
+    size_t renderedLength() const {
+        return ::renderedLength(words, count);
+    }
+
+    // Writes the words separated by spaces to out and returns the position after them
+    template <typename Output>
+    Output renderTo(Output out) const {
+        return renderWords(words, count, out);
+    }
+
+    // Appends the sentence to out, growing it at most once
+    void appendTo(string& out) const {
+        size_t start = out.size();
+        out.resize(start + renderedLength());
+        renderTo(&out[0] + start);
+    }
+
+    bool equals(const SentenceView& other) const {
+        return hash == other.hash && equal(begin(), end(), other.begin(), other.end(),
+                                           [](const Word& a, const Word& b) { return a.equals(b); });
+    }
+
+    bool equals(const Sentence& other) const {
+        const vector<Word>& otherWords = other.getWords();
+        return hashCode() == other.hashCode() && equal(begin(), end(), otherWords.begin(), otherWords.end(),
+                                                       [](const Word& a, const Word& b) { return a.equals(b); });
+    }
+
+    // Same value as Sentence::hashCode for the same words
+    size_t hashCode() const {
+        return static_cast<size_t>(hash);
+    }
+
+    // An owning copy of the sentence
+    Sentence toSentence() const {
+        Sentence sentence;
+        sentence.setWords(vector<Word>(begin(), end()));
+        return sentence;
+    }
+};
+
+// Document whose word arrays, sentence table and title all come from one
+// monotonic arena. Adding a sentence is a bump allocation, and destroying the
+// document hands the arena's few large blocks back at once instead of freeing
+// every word array. Sentences are read through SentenceView.
+class ArenaText {
+private:
+    pmr::monotonic_buffer_resource arena; // Declared first: outlives everything allocated from it
+    pmr::string title;
+    pmr::vector<SentenceView> sentences;
+
+    static_assert(is_trivially_destructible_v<Word>, "Words in the arena are never destroyed");
+
+    // Copies [first, last) into the arena as one array and records it as a sentence
+    template <typename Iterator>
+    const SentenceView& addWords(Iterator first, Iterator last) {
+        size_t count = static_cast<size_t>(distance(first, last));
+        Word* words = count == 0 ? nullptr : static_cast<Word*>(arena.allocate(count * sizeof(Word), alignof(Word)));
+        uint64_t hash = SentenceHash::Empty;
+        for (size_t i = 0; i < count; ++i, ++first) {
+            const Word* word = new (words + i) Word(*first);
+            hash = SentenceHash::extend(hash, *word);
+        }
+        return sentences.emplace_back(words, count, hash);
+    }
+
+public:
+    // initialBytes sizes the arena's first block, later blocks grow
+    // geometrically; all of them come from upstream
+    explicit ArenaText(string_view title, size_t initialBytes = 64 * 1024,
+                       pmr::memory_resource* upstream = pmr::get_default_resource())
+        : arena(initialBytes, upstream), title(title, &arena), sentences(&arena) {}
+
+    ArenaText(const ArenaText&) = delete;
+    ArenaText& operator=(const ArenaText&) = delete;
+
+    const SentenceView& addSentence(const Sentence& sentence) {
+        return addWords(sentence.getWords().begin(), sentence.getWords().end());
+    }
+
+    // Adds a sentence of the words (or word texts) in the forward range [first, last)
+    template <typename Iterator>
+    const SentenceView& addSentence(Iterator first, Iterator last) {
+        static_assert(is_base_of_v<forward_iterator_tag, typename iterator_traits<Iterator>::iterator_category>,
+                      "ArenaText needs the word count up front");
+        return addWords(first, last);
+    }
+
+    const SentenceView& addSentence(initializer_list<string_view> words) {
+        return addWords(words.begin(), words.end());
+    }
+
+    void reserve(size_t sentenceCount) {
+        sentences.reserve(sentenceCount);
+    }
+
+    string_view getTitle() const {
+        return title;
+    }
+
+    void setTitle(string_view newTitle) {
+        title = newTitle;
+    }
+
+    const pmr::vector<SentenceView>& getSentences() const {
+        return sentences;
+    }
+
+    string toString() const {
+        string result;
+        appendTo(result);
+        return result;
+    }
+
+    // Number of characters toString returns
+    size_t renderedLength() const {
+        return TextService::renderedLength(title, sentences);
+    }
+
+    // Writes the text as Text::toString formats it and returns the position after it
+    template <typename Output>
+    Output renderTo(Output out) const {
+        return TextService::renderText(title, sentences, out);
+    }
+
+    // Appends the text to out, growing it at most once
+    void appendTo(string& out) const {
+        TextService::appendText(title, sentences, out);
+    }
+
+    // An owning Text with the same title and sentences
+    Text toText() const {
+        Text text{ string(title) };
+        text.reserve(sentences.size());
+        for (const auto& sentence : sentences) {
+            text.emplaceSentence().appendWords(sentence.begin(), sentence.end());
+        }
+        return text;
+    }
+};
+
+// Direct-mapped cache from token text to Word. Repeated tokens are resolved
+// without taking the WordTable lock; a slot keeps the last word hashed to it.
+class WordCache {
+private:
+    static constexpr size_t SlotCount = 4096;
+    vector<uint64_t> slots = vector<uint64_t>(SlotCount, 0); // Word id + 1, 0 when empty
+
+public:
+    Word lookup(string_view token) {
+        uint64_t& slot = slots[hash<string_view>()(token) & (SlotCount - 1)];
+        if (slot != 0) {
+            Word cached = Word::fromId(static_cast<uint32_t>(slot - 1));
+            if (cached.toStringView() == token) {
+                return cached;
+            }
+        }
+        Word word(token);
+        slot = uint64_t(word.getId()) + 1;
+        return word;
+    }
+};
+
+// Splits a byte stream into sentences of words. Words are separated by spaces,
+// tabs and line breaks; '.', '!' and '?' end a sentence and are not part of
+// any word. Input may arrive in blocks of any size: a word cut by a block
+// boundary is carried over. Each completed, non-empty sentence is passed to
+// sink as an rvalue.
+template <typename Sink>
+class TextTokenizer {
+private:
+    Sink sink;
+    vector<Word> words; // Words of the sentence in progress
+    string partial;     // Start of a word cut by the end of the previous block
+    WordCache cache;
+
+    static bool isTerminator(char c) {
+        return c == '.' || c == '!' || c == '?';
+    }
+
+    static bool isDelimiter(char c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r' || isTerminator(c);
+    }
+
+    static int countTrailingZeros(unsigned mask) {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return static_cast<int>(index);
+#else
+        return __builtin_ctz(mask);
+#endif
+    }
+
+    // Calls visit(position) for every delimiter in data[0 .. size), in order,
+    // testing 16 bytes at a time where SSE2 is available
+    template <typename Visit>
+    static void forEachDelimiter(const char* data, size_t size, Visit visit) {
+        size_t i = 0;
+#if defined(__SSE2__) || defined(_M_X64)
+        const __m128i space = _mm_set1_epi8(' '), tab = _mm_set1_epi8('\t'), newline = _mm_set1_epi8('\n');
+        const __m128i carriageReturn = _mm_set1_epi8('\r'), period = _mm_set1_epi8('.');
+        const __m128i exclamation = _mm_set1_epi8('!'), question = _mm_set1_epi8('?');
+        for (; i + 16 <= size; i += 16) {
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            __m128i hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(bytes, space), _mm_cmpeq_epi8(bytes, tab)),
+                                        _mm_or_si128(_mm_cmpeq_epi8(bytes, newline), _mm_cmpeq_epi8(bytes, carriageReturn)));
+            hits = _mm_or_si128(hits, _mm_or_si128(_mm_cmpeq_epi8(bytes, period),
+                                                   _mm_or_si128(_mm_cmpeq_epi8(bytes, exclamation), _mm_cmpeq_epi8(bytes, question))));
+            for (unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hits)); mask != 0; mask &= mask - 1) {
+                visit(i + countTrailingZeros(mask));
+            }
+        }
+#endif
+        for (; i < size; ++i) {
+            if (isDelimiter(data[i])) {
+                visit(i);
+            }
+        }
+    }
+
+    void addToken(const char* data, size_t length) {
+        if (!partial.empty()) {
+            partial.append(data, length);
+            words.push_back(cache.lookup(partial));
+            partial.clear();
+        } else if (length > 0) {
+            words.push_back(cache.lookup(string_view(data, length)));
+        }
+    }
+
+    void endSentence() {
+        if (!words.empty()) {
+            Sentence sentence;
+            sentence.appendWords(words.begin(), words.end());
+            sink(move(sentence));
+            words.clear();
+        }
+    }
+
+public:
+    explicit TextTokenizer(Sink sink) : sink(move(sink)) {}
+
+    // Tokenizes the next block of input
+    void feed(string_view block) {
+        const char* data = block.data();
+        size_t wordStart = 0;
+        forEachDelimiter(data, block.size(), [&](size_t position) {
+            addToken(data + wordStart, position - wordStart);
+            if (isTerminator(data[position])) {
+                endSentence();
+            }
+            wordStart = position + 1;
+        });
+        partial.append(data + wordStart, block.size() - wordStart);
+    }
+
+    // Ends the input: a trailing word and an unterminated last sentence are kept
+    void finish() {
+        addToken(nullptr, 0);
+        endSentence();
+    }
+};
+
+// Loads Text from files or memory through TextTokenizer
+class TextLoader {
+public:
+    // Bytes read from the file per call; each thread holds one such buffer
+    static inline size_t blockBytes = 1 << 20;
+    // Files are split across threads only into chunks of at least this many bytes
+    static inline size_t minimumChunkBytes = 1 << 22;
+
+    // Adds the sentences of content to text
+    static void tokenize(string_view content, Text& text) {
+        TextTokenizer tokenizer([&](Sentence&& sentence) { text.addSentence(move(sentence)); });
+        tokenizer.feed(content);
+        tokenizer.finish();
+    }
+
+    // Adds the sentences of the file at path to text, reading it block by block.
+    // On one thread sentences go straight into text, so memory beyond text is
+    // one block. With several threads the file is cut into chunks that each
+    // start right after a sentence terminator, so no sentence spans two chunks.
+    // The calling thread tokenizes the first chunk into text while workers
+    // buffer the others, which are appended in file order. On an error the
+    // sentences added so far stay in text.
+    static void load(const string& path, Text& text, unsigned threadCount = 1) {
+        ifstream file(path, ios::binary);
+        if (!file) {
+            throw runtime_error("Cannot open file: " + path);
+        }
+        file.seekg(0, ios::end);
+        size_t size = static_cast<size_t>(file.tellg());
+        size_t chunks = max<size_t>(1, min<size_t>(threadCount, size / minimumChunkBytes));
+        vector<size_t> bounds = chunkBounds(file, size, chunks);
+        auto addToText = [&](Sentence&& sentence) { text.addSentence(move(sentence)); };
+        if (chunks == 1) {
+            tokenizeRange(path, 0, size, addToText);
+            return;
+        }
+
+        vector<vector<Sentence>> parts(chunks);
+        vector<exception_ptr> errors(chunks);
+        vector<thread> workers;
+        for (size_t chunk = 1; chunk < chunks; ++chunk) {
+            workers.emplace_back([&, chunk] {
+                try {
+                    tokenizeRange(path, bounds[chunk], bounds[chunk + 1],
+                                  [&](Sentence&& sentence) { parts[chunk].push_back(move(sentence)); });
+                } catch (...) {
+                    errors[chunk] = current_exception();
+                }
+            });
+        }
+        try {
+            tokenizeRange(path, bounds[0], bounds[1], addToText);
+        } catch (...) {
+            errors[0] = current_exception();
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        for (const auto& error : errors) {
+            if (error) {
+                rethrow_exception(error);
+            }
+        }
+
+        size_t total = text.getSentences().size();
+        for (const auto& part : parts) {
+            total += part.size();
+        }
+        text.reserve(total);
+        for (auto& part : parts) {
+            for (auto& sentence : part) {
+                text.addSentence(move(sentence));
+            }
+        }
+    }
+
+private:
+    // Tokenizes bytes [first, last) of the file at path, one block at a time
+    template <typename Sink>
+    static void tokenizeRange(const string& path, size_t first, size_t last, Sink sink) {
+        ifstream in(path, ios::binary);
+        in.seekg(static_cast<streamoff>(first));
+        TextTokenizer<Sink> tokenizer(move(sink));
+        vector<char> buffer(blockBytes);
+        for (size_t left = last - first; left > 0;) {
+            size_t count = min(left, buffer.size());
+            if (!in.read(buffer.data(), static_cast<streamsize>(count))) {
+                throw runtime_error("Cannot read file: " + path);
+            }
+            tokenizer.feed(string_view(buffer.data(), count));
+            left -= count;
+        }
+        tokenizer.finish();
+    }
+
+    // Start offsets of chunks of roughly size / chunks bytes, each moved forward
+    // to just after the next sentence terminator (size when there is none)
+    static vector<size_t> chunkBounds(ifstream& file, size_t size, size_t chunks) {
+        vector<size_t> bounds(chunks + 1, size);
+        bounds[0] = 0;
+        vector<char> buffer(4096);
+        for (size_t chunk = 1; chunk < chunks; ++chunk) {
+            size_t position = max(bounds[chunk - 1], size * chunk / chunks);
+            file.clear();
+            file.seekg(static_cast<streamoff>(position));
+            bounds[chunk] = size;
+            while (position < size) {
+                size_t count = min(buffer.size(), size - position);
+                file.read(buffer.data(), static_cast<streamsize>(count));
+                auto terminator = find_if(buffer.begin(), buffer.begin() + count,
+                                          [](char c) { return c == '.' || c == '!' || c == '?'; });
+                if (terminator != buffer.begin() + count) {
+                    bounds[chunk] = position + (terminator - buffer.begin()) + 1;
+                    break;
+                }
+                position += count;
+            }
+        }
+        return bounds;
+    }
 };
 
 #include <gtest/gtest.h> 
@@ -235,6 +1429,62 @@ INSTANTIATE_TEST_CASE_P(
     )
 ); 
 
+TEST(WordTableTest, Interning_SameTextSameId) {
+    Word first{ "interned" };
+    Word second{ string("intern") + "ed" };
+    Word other{ "different" };
+    EXPECT_EQ(first.getId(), second.getId());
+    EXPECT_NE(first.getId(), other.getId());
+    EXPECT_TRUE(first.equals(second));
+    EXPECT_EQ(first.toStringView().data(), second.toStringView().data()); // One stored copy
+    EXPECT_EQ(sizeof(Word), sizeof(uint32_t));
+}
+
+TEST(WordTableTest, Interning_ManyDistinctWords) {
+    vector<Word> words;
+    for (int i = 0; i < 5000; ++i) {
+        words.emplace_back("distinct-" + to_string(i));
+    }
+    for (int i = 0; i < 5000; ++i) {
+        string expected = "distinct-" + to_string(i);
+        EXPECT_EQ(words[i].toStringView(), expected);
+        EXPECT_EQ(words[i].hashCode(), hash<string>()(expected));
+    }
+}
+
+TEST(WordTableTest, SetValue_ReinternsWord) {
+    Word word{ "before" };
+    Word same{ "after" };
+    word.setValue("after");
+    EXPECT_TRUE(word.equals(same));
+    EXPECT_EQ(word.toString(), "after");
+}
+
+// A million words drawn from a 20k vocabulary, held as Words and as strings
+TEST(WordTableTest, Memory_LargeCorpus) {
+    const size_t corpusSize = 1000000;
+    vector<string> vocabulary;
+    for (int i = 0; i < 20000; ++i) {
+        vocabulary.push_back("corpus" + string(i % 15, 'x') + to_string(i));
+    }
+
+    size_t tableBefore = WordTable::global().memoryFootprint();
+    vector<Word> words;
+    words.reserve(corpusSize);
+    size_t stringBytes = corpusSize * sizeof(string);
+    for (size_t i = 0; i < corpusSize; ++i) {
+        const string& text = vocabulary[(i * 7919) % vocabulary.size()];
+        words.emplace_back(text);
+        if (text.size() > string().capacity()) {
+            stringBytes += text.size() + 1; // Heap buffer beyond the small-string buffer
+        }
+    }
+    size_t wordBytes = corpusSize * sizeof(Word) + (WordTable::global().memoryFootprint() - tableBefore);
+
+    cout << "Words: " << wordBytes / 1024 << " KiB, strings: " << stringBytes / 1024 << " KiB" << endl;
+    EXPECT_LT(wordBytes * 3, stringBytes);
+}
+
 class SentenceTest : public ::testing::Test {
 public:
     Sentence sentence;
@@ -347,6 +1597,41 @@ TEST_F(SentenceTest, HashCode_EmptySentence) {
     EXPECT_EQ(SentenceService::hashCode(sentence), SentenceService::hashCode(emptySentence));
 }
 
+TEST_F(SentenceTest, HashCode_OrderSensitive) {
+    Sentence forward;
+    forward.addWord(word1);
+    forward.addWord(word2);
+    Sentence backward;
+    backward.addWord(word2);
+    backward.addWord(word1);
+    EXPECT_NE(forward.hashCode(), backward.hashCode());
+    EXPECT_FALSE(forward.equals(backward));
+}
+
+TEST_F(SentenceTest, HashCode_RepeatedWordsDoNotCancel) {
+    Sentence repeated;
+    repeated.addWord(word1);
+    repeated.addWord(word1);
+    Sentence empty;
+    EXPECT_NE(repeated.hashCode(), empty.hashCode());
+
+    Sentence twice; // "a b a b" versus "a b"
+    twice.setWords({ word1, word2, word1, word2 });
+    Sentence once;
+    once.setWords({ word1, word2 });
+    EXPECT_NE(twice.hashCode(), once.hashCode());
+}
+
+TEST_F(SentenceTest, HashCode_IncrementalMatchesSetWords) {
+    sentence.addWord(word1);
+    sentence.addWord(word2);
+    sentence.addWord(word3);
+    Sentence assigned;
+    assigned.setWords({ word4, word2, word3 });
+    EXPECT_EQ(sentence.hashCode(), assigned.hashCode());
+    EXPECT_TRUE(sentence.equals(assigned));
+}
+
 class SentenceParamTest : public ::testing::TestWithParam<tuple<vector<Word>, string>> {}; //?
 
 TEST_P(SentenceParamTest, ToString_WithParam) {
@@ -431,6 +1716,7 @@ TEST_F(TextTest, PrintText) {
 
     string expectedOutput = "Title: Sample Title\nHello world\nThis is a test\n";
     EXPECT_EQ(actualOutput, expectedOutput);
+    cout.rdbuf(oldCout);
 }
 
 TEST_F(TextTest, ToString) {
@@ -453,6 +1739,53 @@ TEST_F(TextTest, GetSentences_InitiallyEmpty) {
     EXPECT_TRUE(text.getSentences().empty());
 }
 
+TEST_F(TextTest, AppendTo_MatchesToString) {
+    text.addSentence(sentence1);
+    text.addSentence(Sentence{});
+    text.addSentence(sentence2);
+    string expected = "Title: Sample Title\nHello world\n\nThis is a test\n";
+    EXPECT_EQ(text.renderedLength(), expected.size());
+
+    string out = ">";
+    text.appendTo(out);
+    EXPECT_EQ(out, ">" + expected);
+
+    string viaIterator;
+    text.renderTo(back_inserter(viaIterator));
+    EXPECT_EQ(viaIterator, expected);
+
+    out = "[";
+    sentence2.appendTo(out);
+    Word{ "]" }.appendTo(out);
+    EXPECT_EQ(out, "[This is a test]");
+    EXPECT_EQ(sentence2.renderedLength(), 14u);
+    EXPECT_EQ(Sentence{}.renderedLength(), 0u);
+}
+
+// Rendering allocates only the result: toString sizes its string once, and
+// appending to a buffer that already has room leaves the buffer in place
+TEST_F(TextTest, AppendTo_SingleAllocation) {
+    Sentence longSentence;
+    for (int i = 0; i < 100; ++i) {
+        longSentence.addWord(Word{ "rendering" });
+    }
+    vector<Sentence> sentences(2000, longSentence);
+    text.setSentences(sentences);
+
+    string rendered = text.toString();
+    EXPECT_EQ(rendered.size(), text.renderedLength());
+    EXPECT_EQ(rendered.capacity(), rendered.size());
+
+    string buffer;
+    buffer.reserve(rendered.size());
+    const char* data = buffer.data();
+    size_t capacity = buffer.capacity();
+    text.appendTo(buffer);
+    EXPECT_EQ(buffer.data(), data);
+    EXPECT_EQ(buffer.capacity(), capacity);
+    EXPECT_EQ(buffer, rendered);
+}
+
 class TextParamTest : public ::testing::TestWithParam<tuple<string, vector<Sentence>, string>> {};
 
 TEST_P(TextParamTest, ToString_WithParam) {
@@ -498,6 +1831,611 @@ TEST_F(TextTest, Performance_AddSentences) {
     size_t actualSize = text.getSentences().size();
     EXPECT_EQ(actualSize, expectedSize);
     EXPECT_LT(duration.count(), 1.0);
+
+    // The same two-word sentences at scale, built by copying, by moving, and
+    // in place after reserving; reports time and heap allocations per sentence.
+    // A vector's data() moves exactly when it allocates a new array, so
+    // comparing it around each step counts word-array and table allocations.
+    const size_t scaledSentences = 1000000;
+    auto measure = [&](const char* name, auto build) {
+        Text scaled("Scaled");
+        size_t allocations = 0;
+        auto buildStart = chrono::steady_clock::now();
+        build(scaled, allocations);
+        chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - buildStart;
+        double allocationsPerSentence = double(allocations) / scaledSentences;
+        EXPECT_EQ(scaled.getSentences().size(), scaledSentences);
+        EXPECT_EQ(scaled.getSentences().back().toString(), "Sentence " + to_string((scaledSentences - 1) % 1000));
+        cout << name << ": " << elapsed.count() << " ms, " << allocationsPerSentence << " allocations per sentence" << endl;
+        return allocationsPerSentence;
+    };
+    auto tracked = [](size_t& allocations, auto data, auto step) {
+        auto before = data();
+        step();
+        allocations += data() != before;
+    };
+    // Adds sentence to scaled by copy or by move, counting the table's growth
+    // and a word array the stored sentence does not take over from sentence
+    auto addTracked = [&](Text& scaled, size_t& allocations, Sentence& sentence, bool moveIn) {
+        const Word* words = sentence.getWords().data();
+        tracked(allocations, [&] { return scaled.getSentences().data(); }, [&] {
+            if (moveIn) {
+                scaled.addSentence(move(sentence));
+            } else {
+                scaled.addSentence(sentence);
+            }
+        });
+        allocations += scaled.getSentences().back().getWords().data() != words;
+    };
+    vector<string> numbers;
+    for (int i = 0; i < 1000; ++i) {
+        numbers.push_back(to_string(i));
+    }
+    auto buildByAdding = [&](bool moveIn) {
+        return [&, moveIn](Text& scaled, size_t& allocations) {
+            for (size_t i = 0; i < scaledSentences; ++i) {
+                Sentence sentence;
+                auto words = [&] { return sentence.getWords().data(); };
+                tracked(allocations, words, [&] { sentence.addWord(Word{ "Sentence" }); });
+                tracked(allocations, words, [&] { sentence.addWord(Word{ numbers[i % 1000] }); });
+                addTracked(scaled, allocations, sentence, moveIn);
+            }
+        };
+    };
+    double copied = measure("Copy", buildByAdding(false));
+    double moved = measure("Move", buildByAdding(true));
+    double emplaced = measure("Emplace", [&](Text& scaled, size_t& allocations) {
+        auto table = [&] { return scaled.getSentences().data(); };
+        tracked(allocations, table, [&] { scaled.reserve(scaledSentences); });
+        for (size_t i = 0; i < scaledSentences; ++i) {
+            Sentence* sentence = nullptr;
+            tracked(allocations, table, [&] { sentence = &scaled.emplaceSentence(); });
+            auto words = [&] { return sentence->getWords().data(); };
+            tracked(allocations, words, [&] { sentence->reserve(2); });
+            tracked(allocations, words, [&] { sentence->emplaceWord("Sentence"); });
+            tracked(allocations, words, [&] { sentence->emplaceWord(numbers[i % 1000]); });
+        }
+    });
+    EXPECT_LT(moved, copied);
+    EXPECT_LT(emplaced, moved);
+    EXPECT_LT(emplaced, 1.0 + 1e-5); // Only each sentence's word array, plus the table once
+}
+
+TEST_F(TextTest, AppendSentences_BuildsInPlace) {
+    vector<vector<string>> ranges = { { "Hello", "world" }, {}, { "This", "is", "a", "test" } };
+    text.appendSentences(ranges.begin(), ranges.end());
+    EXPECT_EQ(text.toString(), "Title: Sample Title\nHello world\n\nThis is a test\n");
+    EXPECT_TRUE(text.getSentences()[0].equals(sentence1));
+    EXPECT_EQ(text.getSentences()[2].hashCode(), sentence2.hashCode());
+
+    Sentence moved = sentence2;
+    text.addSentence(move(moved));
+    EXPECT_EQ(text.getSentences().back().toString(), "This is a test");
+
+    vector<Sentence> replacement = { sentence1 };
+    text.setSentences(move(replacement));
+    EXPECT_EQ(text.getSentences().size(), 1u);
+
+    Sentence emplaced;
+    emplaced.emplaceWord("Hello");
+    emplaced.emplaceWord(string("world"));
+    EXPECT_TRUE(emplaced.equals(sentence1));
+}
+
+TEST_F(TextTest, ArenaText_ViewsMatchText) {
+    text.addSentence(sentence1);
+    text.addSentence(Sentence{});
+    text.addSentence(sentence2);
+
+    ArenaText arenaText("Sample Title");
+    arenaText.addSentence(sentence1);
+    vector<string> empty;
+    arenaText.addSentence(empty.begin(), empty.end());
+    arenaText.addSentence({ "This", "is", "a", "test" });
+
+    EXPECT_EQ(arenaText.toString(), text.toString());
+    EXPECT_EQ(arenaText.renderedLength(), text.renderedLength());
+    ASSERT_EQ(arenaText.getSentences().size(), 3u);
+    const SentenceView& view = arenaText.getSentences()[2];
+    EXPECT_EQ(view.size(), 4u);
+    EXPECT_EQ(view[3].toString(), "test");
+    EXPECT_EQ(view.toString(), "This is a test");
+    EXPECT_EQ(view.hashCode(), sentence2.hashCode());
+    EXPECT_TRUE(view.equals(sentence2));
+    EXPECT_FALSE(view.equals(arenaText.getSentences()[0]));
+    EXPECT_TRUE(view.toSentence().equals(sentence2));
+
+    Text copy = arenaText.toText();
+    EXPECT_EQ(copy.toString(), text.toString());
+    arenaText.setTitle("Other");
+    EXPECT_EQ(arenaText.getTitle(), "Other");
+}
+
+// Forwards to the default resource, counting the blocks handed out
+class CountingResource : public pmr::memory_resource {
+public:
+    size_t allocations = 0;
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        ++allocations;
+        return pmr::get_default_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        pmr::get_default_resource()->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+// A million eight-word sentences held as Text and as ArenaText: build and
+// teardown time and heap allocations for each
+TEST(ArenaTextTest, Performance_BuildAndTeardown) {
+    const size_t sentenceCount = 1000000;
+    vector<Word> vocabulary;
+    for (int i = 0; i < 1000; ++i) {
+        vocabulary.emplace_back("arena" + to_string(i));
+    }
+    auto wordAt = [&](size_t sentence, size_t position) { return vocabulary[(sentence * 31 + position * 7) % 1000]; };
+
+    auto start = chrono::steady_clock::now();
+    auto text = make_unique<Text>("Owned");
+    text->reserve(sentenceCount);
+    for (size_t i = 0; i < sentenceCount; ++i) {
+        Sentence& sentence = text->emplaceSentence();
+        sentence.reserve(8);
+        for (size_t k = 0; k < 8; ++k) {
+            sentence.addWord(wordAt(i, k));
+        }
+    }
+    chrono::duration<double, milli> textBuild = chrono::steady_clock::now() - start;
+    // The sentence table plus one word array per sentence
+    size_t textAllocations = 1 + count_if(text->getSentences().begin(), text->getSentences().end(),
+                                          [](const Sentence& sentence) { return sentence.getWords().capacity() > 0; });
+    auto teardownStart = chrono::steady_clock::now();
+    text.reset();
+    chrono::duration<double, milli> textTeardown = chrono::steady_clock::now() - teardownStart;
+
+    CountingResource upstream;
+    start = chrono::steady_clock::now();
+    auto arenaText = make_unique<ArenaText>("Arena", 64 * 1024, &upstream);
+    arenaText->reserve(sentenceCount);
+    array<Word, 8> words = { vocabulary[0], vocabulary[0], vocabulary[0], vocabulary[0],
+                             vocabulary[0], vocabulary[0], vocabulary[0], vocabulary[0] };
+    for (size_t i = 0; i < sentenceCount; ++i) {
+        for (size_t k = 0; k < 8; ++k) {
+            words[k] = wordAt(i, k);
+        }
+        arenaText->addSentence(words.begin(), words.end());
+    }
+    auto built = chrono::steady_clock::now();
+    size_t arenaAllocations = upstream.allocations; // Arena blocks requested from upstream
+    EXPECT_EQ(arenaText->getSentences()[12345][3].toString(), wordAt(12345, 3).toString());
+    arenaText.reset();
+    chrono::duration<double, milli> arenaBuild = built - start;
+    chrono::duration<double, milli> arenaTeardown = chrono::steady_clock::now() - built;
+
+    cout << "Text: build " << textBuild.count() << " ms, teardown " << textTeardown.count() << " ms, "
+         << textAllocations << " allocations" << endl;
+    cout << "ArenaText: build " << arenaBuild.count() << " ms, teardown " << arenaTeardown.count() << " ms, "
+         << arenaAllocations << " upstream allocations" << endl;
+    EXPECT_LT(arenaAllocations * 1000, sentenceCount);
+}
+
+static vector<string> sentenceStrings(const Text& text) {
+    vector<string> result;
+    for (const auto& sentence : text.getSentences()) {
+        result.push_back(sentence.toString());
+    }
+    return result;
+}
+
+static string writeTempFile(const string& name, const string& content) {
+    string path = ::testing::TempDir() + name;
+    ofstream(path, ios::binary) << content;
+    return path;
+}
+
+TEST(TextTokenizerTest, SplitsSentencesAndWords) {
+    Text text("Tokens");
+    TextLoader::tokenize("Hello  world. This is\ta test!\r\nIs it? ..! No terminator", text);
+    vector<string> expected = { "Hello world", "This is a test", "Is it", "No terminator" };
+    EXPECT_EQ(sentenceStrings(text), expected);
+    EXPECT_EQ(text.getSentences()[1].getWords()[3].toString(), "test");
+}
+
+TEST(TextTokenizerTest, BlockBoundariesDoNotSplitWords) {
+    string content = "A sentence spanning several blocks, with punctuation; and long-words.\n"
+                     "Second one?  Third one!Trailing words";
+    Text whole("Whole");
+    TextLoader::tokenize(content, whole);
+
+    for (size_t blockSize : { size_t(1), size_t(3), size_t(16), size_t(17) }) {
+        Text blocks("Blocks");
+        TextTokenizer tokenizer([&](Sentence&& sentence) { blocks.addSentence(move(sentence)); });
+        for (size_t i = 0; i < content.size(); i += blockSize) {
+            tokenizer.feed(string_view(content).substr(i, blockSize));
+        }
+        tokenizer.finish();
+        EXPECT_EQ(sentenceStrings(blocks), sentenceStrings(whole)) << "block size " << blockSize;
+        for (size_t i = 0; i < whole.getSentences().size(); ++i) {
+            EXPECT_EQ(blocks.getSentences()[i].hashCode(), whole.getSentences()[i].hashCode());
+        }
+    }
+}
+
+TEST(TextTokenizerTest, Load_ParallelMatchesSequential) {
+    string content;
+    for (int i = 0; i < 5000; ++i) {
+        content += "Sentence number " + to_string(i) + " has words" + (i % 3 == 0 ? "!\n" : ". ");
+    }
+    content += "Last words without terminator";
+    string path = writeTempFile("tokenizer_parallel.txt", content);
+
+    size_t blockBytes = TextLoader::blockBytes, minimumChunkBytes = TextLoader::minimumChunkBytes;
+    TextLoader::blockBytes = 100;
+    TextLoader::minimumChunkBytes = 1000;
+    Text sequential("Sequential"), parallel("Parallel");
+    TextLoader::load(path, sequential);
+    TextLoader::load(path, parallel, 7);
+    TextLoader::blockBytes = blockBytes;
+    TextLoader::minimumChunkBytes = minimumChunkBytes;
+
+    ASSERT_EQ(sequential.getSentences().size(), 5001u);
+    EXPECT_EQ(sequential.getSentences()[4321].toString(), "Sentence number 4321 has words");
+    EXPECT_EQ(sentenceStrings(parallel), sentenceStrings(sequential));
+    remove(path.c_str());
+}
+
+TEST(TextTokenizerTest, Load_MissingFileThrows) {
+    Text text("Missing");
+    EXPECT_THROW(TextLoader::load(::testing::TempDir() + "no_such_file.txt", text), runtime_error);
+}
+
+// Writes a ~64 MB corpus and reports load throughput with one thread and
+// with at least four
+TEST(TextTokenizerTest, Performance_Load) {
+    mt19937 random(23);
+    vector<string> vocabulary;
+    for (int i = 0; i < 20000; ++i) {
+        vocabulary.push_back("token" + to_string(i));
+    }
+    string content;
+    content.reserve(64 << 20);
+    while (content.size() < (64u << 20)) {
+        size_t length = 4 + random() % 12;
+        for (size_t k = 0; k < length; ++k) {
+            content += vocabulary[random() % 100 * (random() % 200 + 1) % vocabulary.size()];
+            content += k + 1 < length ? ' ' : '.';
+        }
+        content += '\n';
+    }
+    string path = writeTempFile("tokenizer_performance.txt", content);
+    double megabytes = content.size() / double(1 << 20);
+    content = string();
+
+    unsigned threads = max(4u, thread::hardware_concurrency());
+    size_t sentenceCount = 0;
+    for (unsigned threadCount : { 1u, threads }) {
+        Text text("Corpus");
+        auto start = chrono::steady_clock::now();
+        TextLoader::load(path, text, threadCount);
+        chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+        cout << threadCount << " thread(s): " << text.getSentences().size() << " sentences, "
+             << megabytes / elapsed.count() << " MB/s" << endl;
+        if (sentenceCount == 0) {
+            sentenceCount = text.getSentences().size();
+        }
+        EXPECT_EQ(text.getSentences().size(), sentenceCount);
+    }
+    remove(path.c_str());
+}
+
+static Sentence sentenceOf(initializer_list<string_view> words) {
+    Sentence sentence;
+    sentence.appendWords(words.begin(), words.end());
+    return sentence;
+}
+
+TEST(SentenceIndexTest, FindsFirstOccurrence) {
+    Text text("Indexed");
+    text.addSentence(sentenceOf({ "a", "b" }));
+    text.addSentence(sentenceOf({ "b", "a" }));
+    text.addSentence(sentenceOf({ "a", "b" }));
+    text.addSentence(Sentence());
+    SentenceIndex index(text);
+
+    EXPECT_EQ(index.size(), 3u);
+    EXPECT_EQ(index.find(sentenceOf({ "a", "b" })), 0u);
+    EXPECT_EQ(index.find(sentenceOf({ "b", "a" })), 1u);
+    EXPECT_EQ(index.find(Sentence()), 3u);
+    EXPECT_TRUE(index.contains(sentenceOf({ "b", "a" })));
+    EXPECT_FALSE(index.contains(sentenceOf({ "a", "b", "a" })));
+    EXPECT_EQ(index.find(sentenceOf({ "c" })), SentenceIndex::npos);
+}
+
+TEST(SentenceIndexTest, EmptyText) {
+    Text text("Empty");
+    SentenceIndex index(text);
+    EXPECT_EQ(index.size(), 0u);
+    EXPECT_FALSE(index.contains(sentenceOf({ "a" })));
+    EXPECT_EQ(text.dedup(), 0u);
+}
+
+TEST(SentenceIndexTest, Dedup_KeepsFirstInOrder) {
+    Text text("Duplicates");
+    for (auto words : { vector<string>{ "x", "y" }, { "z" }, { "x", "y" }, { "y", "x" }, { "z" }, { "x", "y" } }) {
+        Sentence sentence;
+        sentence.appendWords(words.begin(), words.end());
+        text.addSentence(sentence);
+    }
+    EXPECT_EQ(text.dedup(), 3u);
+    vector<string> expected = { "x y", "z", "y x" };
+    EXPECT_EQ(sentenceStrings(text), expected);
+    EXPECT_EQ(text.dedup(), 0u);
+}
+
+static Text duplicateHeavyText(size_t sentenceCount, size_t distinct) {
+    mt19937 random(29);
+    vector<Word> vocabulary;
+    for (int i = 0; i < 2000; ++i) {
+        vocabulary.emplace_back("dup" + to_string(i));
+    }
+    vector<vector<Word>> patterns(distinct);
+    for (auto& pattern : patterns) {
+        for (size_t k = 0, length = 3 + random() % 8; k < length; ++k) {
+            pattern.push_back(vocabulary[random() % vocabulary.size()]);
+        }
+    }
+    Text text("Corpus");
+    text.reserve(sentenceCount);
+    for (size_t i = 0; i < sentenceCount; ++i) {
+        const auto& pattern = patterns[random() % distinct];
+        text.emplaceSentence().appendWords(pattern.begin(), pattern.end());
+    }
+    return text;
+}
+
+TEST(SentenceIndexTest, ConcurrentBuildMatchesSequential) {
+    Text text = duplicateHeavyText(300000, 50000);
+    SentenceIndex sequential(text), concurrent(text, 4);
+    EXPECT_EQ(concurrent.size(), sequential.size());
+    for (const auto& sentence : text.getSentences()) {
+        ASSERT_EQ(concurrent.find(sentence), sequential.find(sentence));
+    }
+
+    Text parallelDedup = text;
+    EXPECT_EQ(parallelDedup.dedup(4), text.getSentences().size() - sequential.size());
+    EXPECT_EQ(parallelDedup.getSentences().size(), sequential.size());
+}
+
+// Duplicate detection with the pairwise equals scan and with SentenceIndex
+TEST(SentenceIndexTest, Performance_DedupVersusPairwise) {
+    const size_t sentenceCount = 20000;
+    Text text = duplicateHeavyText(sentenceCount, sentenceCount / 2);
+
+    auto start = chrono::steady_clock::now();
+    size_t pairwiseDuplicates = 0;
+    const auto& sentences = text.getSentences();
+    for (size_t i = 0; i < sentences.size(); ++i) {
+        for (size_t j = 0; j < i; ++j) {
+            if (sentences[i].equals(sentences[j])) {
+                ++pairwiseDuplicates;
+                break;
+            }
+        }
+    }
+    chrono::duration<double, milli> pairwise = chrono::steady_clock::now() - start;
+
+    Text indexed = text;
+    start = chrono::steady_clock::now();
+    size_t indexDuplicates = indexed.dedup();
+    chrono::duration<double, milli> index = chrono::steady_clock::now() - start;
+
+    Text large = duplicateHeavyText(2000000, 500000);
+    unsigned threads = max(4u, thread::hardware_concurrency());
+    start = chrono::steady_clock::now();
+    SentenceIndex sequential(large);
+    chrono::duration<double, milli> sequentialBuild = chrono::steady_clock::now() - start;
+    start = chrono::steady_clock::now();
+    SentenceIndex concurrent(large, threads);
+    chrono::duration<double, milli> concurrentBuild = chrono::steady_clock::now() - start;
+
+    cout << sentenceCount << " sentences: pairwise scan " << pairwise.count() << " ms, dedup " << index.count() << " ms" << endl;
+    cout << large.getSentences().size() << " sentences: index build " << sequentialBuild.count() << " ms, on "
+         << threads << " threads " << concurrentBuild.count() << " ms" << endl;
+    EXPECT_EQ(indexDuplicates, pairwiseDuplicates);
+    EXPECT_EQ(concurrent.size(), sequential.size());
+    EXPECT_LT(index.count(), pairwise.count());
+}
+
+TEST(WordIndexTest, QueriesFollowAddSentence) {
+    IndexedText text("Indexed");
+    text.addSentence(sentenceOf({ "red", "fish", "red" }));
+    text.addSentence(sentenceOf({ "blue", "fish" }));
+    EXPECT_EQ(text.getIndex().sentencesWith(Word("red")), vector<uint32_t>({ 0 }));
+    text.addSentence(sentenceOf({ "red", "blue" }));
+
+    const WordIndex& index = text.getIndex();
+    EXPECT_EQ(index.size(), 3u);
+    EXPECT_EQ(index.frequency(Word("red")), 2u);
+    EXPECT_EQ(index.sentencesWith(Word("fish")), vector<uint32_t>({ 0, 1 }));
+    EXPECT_EQ(index.allOf({ Word("red"), Word("blue") }), vector<uint32_t>({ 2 }));
+    EXPECT_EQ(index.allOf({ Word("fish"), Word("red"), Word("blue") }), vector<uint32_t>());
+    EXPECT_EQ(index.anyOf({ Word("fish"), Word("blue") }), vector<uint32_t>({ 0, 1, 2 }));
+    EXPECT_EQ(index.sentencesWith(Word("indexAbsentWord")), vector<uint32_t>());
+    EXPECT_EQ(index.allOf({}), vector<uint32_t>());
+    EXPECT_EQ(text.getText().getSentences()[2].toString(), "red blue");
+}
+
+// Long lists spanning many blocks and large gaps, checked against set algorithms
+TEST(WordIndexTest, GallopingMatchesSetAlgorithms) {
+    Word every("every"), third("third"), sparse("sparse"), bursty("bursty");
+    WordIndex index;
+    vector<uint32_t> thirds, sparses, burstys;
+    for (uint32_t id = 0; id < 200000; ++id) {
+        Sentence sentence;
+        sentence.addWord(every);
+        if (id % 3 == 0) {
+            sentence.addWord(third);
+            thirds.push_back(id);
+        }
+        if (id % 9973 == 0 || id == 199999) {
+            sentence.addWord(sparse);
+            sparses.push_back(id);
+        }
+        if (id / 1000 % 7 == 0) {
+            sentence.addWord(bursty);
+            burstys.push_back(id);
+        }
+        index.addSentence(sentence);
+    }
+    auto intersect = [](const vector<uint32_t>& a, const vector<uint32_t>& b) {
+        vector<uint32_t> result;
+        set_intersection(a.begin(), a.end(), b.begin(), b.end(), back_inserter(result));
+        return result;
+    };
+    auto unite = [](const vector<uint32_t>& a, const vector<uint32_t>& b) {
+        vector<uint32_t> result;
+        set_union(a.begin(), a.end(), b.begin(), b.end(), back_inserter(result));
+        return result;
+    };
+
+    EXPECT_EQ(index.sentencesWith(third), thirds);
+    EXPECT_EQ(index.allOf({ every, sparse }), sparses);
+    EXPECT_EQ(index.allOf({ third, sparse }), intersect(thirds, sparses));
+    EXPECT_EQ(index.allOf({ bursty, third }), intersect(burstys, thirds));
+    EXPECT_EQ(index.allOf({ third, bursty, sparse }), intersect(intersect(thirds, burstys), sparses));
+    EXPECT_EQ(index.anyOf({ sparse, bursty }), unite(sparses, burstys));
+    EXPECT_LT(index.memoryFootprint(), 200000 * sizeof(uint32_t));
+
+    // The footprint follows the index's own words, not every interned id
+    WordIndex single;
+    single.addSentence(sentenceOf({ "every", "third", "sparse", "bursty" }));
+    EXPECT_LT(single.memoryFootprint(), 1024u);
+}
+
+// Indexes 10M sentences drawn from a skewed vocabulary and reports the mean
+// time of AND queries pairing rare and common words, and of OR over rare words
+TEST(WordIndexTest, Performance_Queries) {
+    const size_t sentenceCount = 10000000;
+    mt19937 random(31);
+    vector<Word> vocabulary;
+    for (int i = 0; i < 50000; ++i) {
+        vocabulary.emplace_back("term" + to_string(i));
+    }
+    auto buildStart = chrono::steady_clock::now();
+    WordIndex index;
+    Sentence sentence;
+    vector<Word> words;
+    for (size_t i = 0; i < sentenceCount; ++i) {
+        words.clear();
+        for (int k = 0; k < 6; ++k) {
+            double u = (random() & 0xFFFFFF) / double(1 << 24);
+            words.push_back(vocabulary[static_cast<size_t>(50000 * u * u * u)]);
+        }
+        sentence.setWords(move(words));
+        index.addSentence(sentence);
+        words = vector<Word>();
+    }
+    chrono::duration<double> build = chrono::steady_clock::now() - buildStart;
+
+    const Word& common = vocabulary[0];
+    size_t queries = 0, matches = 0;
+    auto start = chrono::steady_clock::now();
+    for (int i = 40000; i < 41000; ++i) {
+        matches += index.allOf({ vocabulary[i], common }).size();
+        ++queries;
+    }
+    chrono::duration<double, micro> andTime = chrono::steady_clock::now() - start;
+    start = chrono::steady_clock::now();
+    for (int i = 40000; i < 41000; i += 2) {
+        matches += index.anyOf({ vocabulary[i], vocabulary[i + 1] }).size();
+    }
+    chrono::duration<double, micro> orTime = chrono::steady_clock::now() - start;
+
+    vector<uint32_t> rare = index.sentencesWith(vocabulary[40000]), frequent = index.sentencesWith(common), expected;
+    set_intersection(rare.begin(), rare.end(), frequent.begin(), frequent.end(), back_inserter(expected));
+    EXPECT_EQ(index.allOf({ common, vocabulary[40000] }), expected);
+
+    cout << sentenceCount << " sentences indexed in " << build.count() << " s, "
+         << index.memoryFootprint() / (1 << 20) << " MB of postings; '" << common.toString() << "' in "
+         << index.frequency(common) << " sentences" << endl;
+    cout << "AND rare+common: " << andTime.count() / queries << " us/query, OR rare+rare: "
+         << orTime.count() / (queries / 2) << " us/query (" << matches << " matches)" << endl;
+    EXPECT_LT(andTime.count() / queries, 1000.0);
+}
+
+// Sentences of a Zipf-like corpus plus every one reversed and with its first
+// pair repeated, the cases where the old XOR of word hashes collides.
+// Reports distinct hash values and unordered_set lookup time for both hashes.
+TEST(SentenceHashTest, Performance_HashTable) {
+    const size_t sentenceCount = 100000;
+    mt19937 random(19);
+    vector<Word> vocabulary;
+    for (int i = 0; i < 5000; ++i) {
+        vocabulary.emplace_back("term" + to_string(i));
+    }
+    auto zipfWord = [&] {
+        double u = uniform_real_distribution<double>(0.0, 1.0)(random);
+        return vocabulary[static_cast<size_t>(pow(vocabulary.size(), u)) - 1];
+    };
+
+    vector<Sentence> corpus;
+    for (size_t i = 0; i < sentenceCount; ++i) {
+        vector<Word> words;
+        for (int length = 5 + random() % 11; length > 0; --length) {
+            words.push_back(zipfWord());
+        }
+        Sentence sentence;
+        sentence.setWords(words);
+        corpus.push_back(sentence);
+        reverse(words.begin(), words.end());
+        sentence.setWords(words);
+        corpus.push_back(sentence);
+        words.insert(words.begin(), { words[0], words[1] });
+        sentence.setWords(words);
+        corpus.push_back(sentence);
+    }
+
+    struct SentenceEquals {
+        bool operator()(const Sentence& a, const Sentence& b) const { return a.equals(b); }
+    };
+    struct RollingHash {
+        size_t operator()(const Sentence& s) const { return s.hashCode(); }
+    };
+    struct XorHash {
+        size_t operator()(const Sentence& s) const {
+            size_t hash = 0;
+            for (const auto& word : s.getWords()) {
+                hash ^= word.hashCode();
+            }
+            return hash;
+        }
+    };
+    auto measure = [&](const char* name, auto hasher) {
+        unordered_set<size_t> hashes;
+        for (const auto& sentence : corpus) {
+            hashes.insert(hasher(sentence));
+        }
+        unordered_set<Sentence, decltype(hasher), SentenceEquals> table(corpus.begin(), corpus.end(), 0, hasher);
+        auto start = chrono::steady_clock::now();
+        size_t found = 0;
+        for (const auto& sentence : corpus) {
+            found += table.count(sentence);
+        }
+        chrono::duration<double, nano> elapsed = chrono::steady_clock::now() - start;
+        EXPECT_EQ(found, corpus.size());
+        cout << name << ": " << table.size() << " distinct sentences, " << hashes.size() << " distinct hashes, "
+             << elapsed.count() / corpus.size() << " ns per lookup" << endl;
+        return hashes.size();
+    };
+    size_t rollingHashes = measure("Rolling hash", RollingHash());
+    size_t xorHashes = measure("XOR hash", XorHash());
+    EXPECT_GT(rollingHashes, xorHashes);
 }
 
 int main(int argc, char** argv) {